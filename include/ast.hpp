@@ -16,6 +16,7 @@
 #include "llvm/IR/Verifier.h"
 #include "common.hpp"
 #include "ast_visitor.hpp"
+#include "libmetainfo.hpp"
 
 namespace llscm {
 	using namespace std;
@@ -60,6 +61,7 @@ namespace llscm {
 	 */
 	class ScmObj;
 	class ScmEnv;
+	class ScmCodeGen;
 
 	typedef shared_ptr<ScmObj> P_ScmObj;
 	typedef shared_ptr<ScmEnv> P_ScmEnv;
@@ -319,11 +321,22 @@ namespace llscm {
 			argc_expected = argc;
 			has_closure = false;
 			passing_closure = false;
+			is_native = false;
+			stack_closures = false;
 			IR_heap_storage = nullptr;
 			IR_context_ptr = nullptr;
 			IR_wrapper_fn_ptr = nullptr;
+			has_self_tail_call = false;
+			IR_loop_header = nullptr;
+			facts = 0;
+			noescape_args = 0;
 		}
 		virtual P_ScmObj CT_Eval(P_ScmEnv env);
+		// Primitive functions can generate their code inline
+		// at the call site. The default is a regular call.
+		virtual Value * genInline(ScmCodeGen * cg, const vector<Value*> & args) {
+			return nullptr;
+		}
 		void addHeapLocal(P_ScmObj obj) {
 			// Zero index is reserved for a pointer to the parent heap data
 			heap_local_idx[obj.get()] = (int)heap_local_idx.size() + 1;
@@ -343,62 +356,115 @@ namespace llscm {
 		// Function which takes context pointer and has to make it
 		// available to another closure function defined inside it.
 		bool passing_closure;
+		// Function calls itself in tail position
+		bool has_self_tail_call;
+		// Implemented in the runtime library (C calling convention).
+		// Compiled Scheme functions use fastcc and always take the context pointer.
+		bool is_native;
+		// Heap storage and closure objects created by the function
+		// don't outlive its activation (see escape.hpp).
+		bool stack_closures;
+		// FunctionFact flags (see libmetainfo.hpp), computed by facts.hpp
+		// or loaded from the library metadata
+		uint32_t facts;
+		// Arguments which don't escape the call (bit mask),
+		// known for the functions from other modules only
+		uint32_t noescape_args;
 		Value * IR_heap_storage;
 		Value * IR_context_ptr;
 		Function * IR_wrapper_fn_ptr;
+		// Self tail calls jump to the loop header and
+		// pass the new argument values to its phi nodes.
+		BasicBlock * IR_loop_header;
+		vector<PHINode*> IR_loop_args;
 	};
 
 	// Derived function classes for specialized code generation
 	// of the function's bodies. We need this to support inlining.
-	// TODO: inlining
+	// The inline code is a fast path for the common argument types,
+	// everything else falls back to the runtime library function.
 	class ScmConsFunc: public Visitable<ScmConsFunc, ScmFunc> {
 	public:
 		ScmConsFunc();
+		virtual Value * genInline(ScmCodeGen * cg, const vector<Value*> & args);
 	};
 
 	class ScmCarFunc: public Visitable<ScmCarFunc, ScmFunc> {
 	public:
 		ScmCarFunc();
+		virtual Value * genInline(ScmCodeGen * cg, const vector<Value*> & args);
 	};
 
 	class ScmCdrFunc: public Visitable<ScmCdrFunc, ScmFunc> {
 	public:
 		ScmCdrFunc();
+		virtual Value * genInline(ScmCodeGen * cg, const vector<Value*> & args);
 	};
 
 	class ScmNullFunc: public Visitable<ScmNullFunc, ScmFunc> {
 	public:
 		ScmNullFunc();
+		virtual Value * genInline(ScmCodeGen * cg, const vector<Value*> & args);
 	};
 
 	class ScmPlusFunc: public Visitable<ScmPlusFunc, ScmFunc> {
 	public:
 		ScmPlusFunc();
+		virtual Value * genInline(ScmCodeGen * cg, const vector<Value*> & args);
 	};
 
 	class ScmMinusFunc: public Visitable<ScmMinusFunc, ScmFunc> {
 	public:
 		ScmMinusFunc();
+		virtual Value * genInline(ScmCodeGen * cg, const vector<Value*> & args);
 	};
 
 	class ScmTimesFunc: public Visitable<ScmTimesFunc, ScmFunc> {
 	public:
 		ScmTimesFunc();
+		virtual Value * genInline(ScmCodeGen * cg, const vector<Value*> & args);
 	};
 
 	class ScmDivFunc: public Visitable<ScmDivFunc, ScmFunc> {
 	public:
 		ScmDivFunc();
+		virtual Value * genInline(ScmCodeGen * cg, const vector<Value*> & args);
 	};
 
 	class ScmGtFunc: public Visitable<ScmGtFunc, ScmFunc> {
 	public:
 		ScmGtFunc();
+		virtual Value * genInline(ScmCodeGen * cg, const vector<Value*> & args);
+	};
+
+	class ScmLtFunc: public Visitable<ScmLtFunc, ScmFunc> {
+	public:
+		ScmLtFunc();
+		virtual Value * genInline(ScmCodeGen * cg, const vector<Value*> & args);
+	};
+
+	class ScmLeFunc: public Visitable<ScmLeFunc, ScmFunc> {
+	public:
+		ScmLeFunc();
+		virtual Value * genInline(ScmCodeGen * cg, const vector<Value*> & args);
+	};
+
+	class ScmGeFunc: public Visitable<ScmGeFunc, ScmFunc> {
+	public:
+		ScmGeFunc();
+		virtual Value * genInline(ScmCodeGen * cg, const vector<Value*> & args);
 	};
 
 	class ScmNumEqFunc: public Visitable<ScmNumEqFunc, ScmFunc> {
 	public:
 		ScmNumEqFunc();
+		virtual Value * genInline(ScmCodeGen * cg, const vector<Value*> & args);
+	};
+
+	class ScmEqFunc: public Visitable<ScmEqFunc, ScmFunc> {
+	public:
+		ScmEqFunc();
+		virtual Value * genInline(ScmCodeGen * cg, const vector<Value*> & args);
 	};
 
 	class ScmDisplayFunc: public Visitable<ScmDisplayFunc, ScmFunc> {
@@ -419,6 +485,7 @@ namespace llscm {
 	class ScmVecRefFunc: public Visitable<ScmVecRefFunc, ScmFunc> {
 	public:
 		ScmVecRefFunc();
+		virtual Value * genInline(ScmCodeGen * cg, const vector<Value*> & args);
 	};
 
 	class ScmApplyFunc: public Visitable<ScmApplyFunc, ScmFunc> {
@@ -438,6 +505,8 @@ namespace llscm {
 		ScmCall(P_ScmObj f, P_ScmObj args): // Unresolved call
 				Visitable(T_CALL), fexpr(move(f)), arg_list(move(args)) {
 			argc = -1;
+			tail_call = false;
+			self_tail_call = false;
 		}
 		virtual P_ScmObj CT_Eval(P_ScmEnv env);
 
@@ -445,17 +514,9 @@ namespace llscm {
 		P_ScmObj arg_list;
 		int32_t argc;
 		bool indirect;
-	};
-
-	/*
-	 * TODO: Delete this class. Instead we will have inlinable ScmFunc types.
-	 * Each derived ScmFunc class will be able to generate inline code
-	 * and the corresponding ScmCall will control whether it wants
-	 * the inline or the full version of the function code.
-	 */
-	class ScmInlineCall: public Visitable<ScmInlineCall, ScmCall> {
-	public:
-		ScmInlineCall(P_ScmObj args): Visitable(nullptr, move(args)) {}
+		// Set by markTailCalls (see tailcall.hpp)
+		bool tail_call;
+		bool self_tail_call;
 	};
 
 	class ScmDefineSyntax: public Visitable<ScmDefineSyntax, ScmObj> {
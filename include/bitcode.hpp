@@ -0,0 +1,28 @@
+#ifndef LLSCHEME_BITCODE_HPP
+#define LLSCHEME_BITCODE_HPP
+
+#include <memory>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/IR/Module.h>
+
+namespace llscm {
+    using namespace llvm;
+
+    // Global array with the bitcode of the library module
+    extern const char * EmbeddedBitcodeSym;
+
+    // Appends the bitcode of mod to the module itself (as EmbeddedBitcodeSym)
+    void embedBitcode(Module & mod);
+
+    // Links the library functions mod calls as available_externally definitions,
+    // so that the optimizer can inline them. The calls which are not inlined
+    // still go to the library. Functions using private library state are skipped.
+    bool importBitcode(Module & mod, StringRef bitcode);
+
+    // Links the whole library into mod (library code and state included).
+    // The library constructor is kept, so it still runs before main.
+    bool linkLibrary(Module & mod, std::unique_ptr<Module> lib);
+    bool linkBitcode(Module & mod, StringRef bitcode);
+}
+
+#endif //LLSCHEME_BITCODE_HPP
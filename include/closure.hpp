@@ -0,0 +1,42 @@
+#ifndef LLSCHEME_CLOSURE_HPP
+#define LLSCHEME_CLOSURE_HPP
+
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "ast.hpp"
+
+namespace llscm {
+    using namespace std;
+
+    // Flat closure conversion. Instead of the chain of heap storages
+    // (parent pointer at index 0) every closure gets its own record
+    // with all the variables it needs, filled in when the closure is created.
+    // Parameters and let bindings are copied by value. Variables bound by
+    // a nested define may be initialized after the closure is created,
+    // so the record holds a pointer (box) to their slot in the heap storage.
+    class FlatClosures {
+        // Free variables of the function in the order of the record fields
+        unordered_map<ScmFunc*, vector<ScmObj*>> free_vars;
+        unordered_map<ScmFunc*, unordered_map<ScmObj*, int32_t>> var_idx;
+        unordered_set<ScmObj*> boxed;
+        unordered_set<ScmFunc*> boxed_locals;
+    public:
+        // Computes the closure records of all the functions defined in prog
+        void analyze(ScmObj * prog);
+        const vector<ScmObj*> & freeVars(ScmFunc * func) {
+            return free_vars[func];
+        }
+        // Index of the variable in the closure record of func
+        int32_t index(ScmFunc * func, ScmObj * var);
+        bool isBoxed(ScmObj * var) {
+            return boxed.count(var) > 0;
+        }
+        // Some closure records point to the heap storage of func
+        bool hasBoxedLocals(ScmFunc * func) {
+            return boxed_locals.count(func) > 0;
+        }
+    };
+}
+
+#endif //LLSCHEME_CLOSURE_HPP
@@ -3,13 +3,21 @@
 
 #include <memory>
 #include <vector>
+#include <unordered_set>
+#include <unordered_map>
 #include <utility>
 #include <llvm/IR/Module.h>
 #include <llvm/IR/LLVMContext.h>
 #include <llvm/IR/IRBuilder.h>
 #include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/Target/TargetMachine.h>
 #include "ast_visitor.hpp"
 #include "ast.hpp"
+#include "tailcall.hpp"
+#include "escape.hpp"
+#include "closure.hpp"
+#include "facts.hpp"
 #include "debug.hpp"
 #include "runtime/types.hpp"
 #include "../include/libmetainfo.hpp"
@@ -27,7 +35,14 @@ namespace llscm {
         static const char *minus;
         static const char *times;
         static const char *div;
+        static const char *plus2;
+        static const char *minus2;
+        static const char *times2;
+        static const char *div2;
         static const char *gt;
+        static const char *lt;
+        static const char *le;
+        static const char *ge;
         static const char *display;
         static const char *num_eq;
         static const char *cmd_args;
@@ -38,11 +53,15 @@ namespace llscm {
         static const char *exit_code;
         static const char *alloc_heap_storage;
         static const char *alloc_func;
+        static const char *alloc_cons;
+        static const char *intern_static_sym;
+        static const char *eq;
         static const char *error_not_a_func;
         static const char *error_wrong_arg_num;
         static const char *apply;
         static const char *length;
         static const char *eval;
+        static const char *eval_batch;
         static const char *make_base_nspace;
         static const char *current_nspace;
         static const char *read;
@@ -61,6 +80,11 @@ namespace llscm {
         static const char *equal;
         static const char *exit;
         static const char *random;
+        static const char *collect_garbage;
+        // Constant::scm_null, scm_true and scm_false of the runtime (mangled names)
+        static const char *null_obj;
+        static const char *true_obj;
+        static const char *false_obj;
     };
 
     class ScmCodeGen: public AstVisitor {
@@ -68,14 +92,38 @@ namespace llscm {
         shared_ptr<Module> module;
         IRBuilder<> builder;
         unique_ptr<legacy::FunctionPassManager> passman;
+        // 0 disables the IR optimizations
+        unsigned optlevel;
 
         VisitableObj * ast;
-        Metadata output_meta;
+        MetadataBuilder output_meta;
+        // Results of the calls known to return a fixnum (FN_RET_FIXNUM)
+        unordered_set<Value*> fixnum_vals;
+        // Results of the calls known to return #t or #f (FN_RET_BOOL),
+        // these are never fixnums
+        unordered_set<Value*> bool_vals;
+        EscapeInfo escape;
+        // Closure records instead of the chained heap storages
+        bool flat_closures;
+        FlatClosures flat;
 
         GlobalVariable * g_exit_code;
         GlobalVariable * g_argv;
         // Library constructors (called on module load)
         GlobalVariable * g_ctors;
+        // Symbol objects defined in this module (registered by the entry function)
+        vector<GlobalVariable*> static_syms;
+        // Another module may have interned the symbol first. The code loads
+        // each symbol from a slot which the entry function sets
+        // to the runtime's object (genSymbolInit).
+        unordered_map<GlobalVariable*, GlobalVariable*> sym_slots;
+        // Fields of the quoted lists pointing to the symbols, set the same way
+        struct SymField {
+            GlobalVariable * cons;
+            int32_t field;
+            GlobalVariable * sym;
+        };
+        vector<SymField> sym_fields;
 
         Function * entry_func;
         string entry_func_name;
@@ -107,6 +155,8 @@ namespace llscm {
 
         struct {
             Function * alloc_func;
+            Function * alloc_cons;
+            Function * intern_static_sym;
             Function * alloc_heap_storage;
             Function * error_not_a_func;
             Function * error_wrong_arg_num;
@@ -159,15 +209,32 @@ namespace llscm {
         void addExprFuncEpilog(Value * last_val);
 
         Value * genGlobalConstant(Constant * c);
+        Value * genRuntimeConstant(const char * name);
+        Constant * genFixnumConstant(int64_t val);
+        Value * genIsFixnum(Value * obj);
+        // Null unless the tag is known at compile time
+        Value * genKnownTag(Value * obj);
+        Value * genGetTag(Value * obj);
 
         Value * genAllocHeapStorage(int32_t size);
+        Value * genStackHeapStorage(int32_t size);
+        Value * genEntryAlloca(Type * type, int32_t size);
+        Value * genFlatRecord(ScmFunc * curr_func, ScmFunc * fn_obj, bool on_stack);
+        Value * genFlatLoad(ScmFunc * curr_func, ScmObj * var);
         void genHeapStore(Value * hs, Value * obj, int32_t idx);
         Value * genHeapLoad(Value * hs, int32_t idx);
 
         Value * genAllocFunc(int32_t argc, Function * fnptr,
                              Function * wrfnptr, Value * ctxptr);
+        Value * genStackFunc(int32_t argc, Function * fnptr,
+                             Function * wrfnptr, Value * ctxptr);
         Value * genConstFunc(int32_t argc, Function * fnptr, Function * wrfnptr);
         vector<Value*> genArgValues(const ScmCall * node);
+        FunctionType * getSchemeFnType(int32_t argc);
+        Function * genNativeTrampoline(ScmFunc * fn_obj, Function * native);
+        Value * genTailReturn(CallInst * call);
+        void genTailRecLoop(ScmFunc * node, BasicBlock * entry_bb);
+        Value * genSelfTailCall(ScmFunc * fn_obj, const vector<Value*> & args);
         //void testAstVisit();
         template<typename F1, typename F2, typename F3>
         Value * genIfElse(F1 cond_expr, F2 then_expr, F3 else_expr) {
@@ -201,6 +268,67 @@ namespace llscm {
             return phi;
         }
 
+        MDNode * genBranchWeights(uint32_t likely, uint32_t unlikely);
+        Value * genTagEquals(Value * obj, Tag tag);
+        Value * genBoolean(Value * cond);
+        Value * genNativeCall(ScmFunc * fn_obj, vector<Value*> args);
+        Value * genBinaryCall(const char * name, const vector<Value*> & args);
+        Value * genOverflowOp(Intrinsic::ID op, Value * a, Value * b, Value *& overflow);
+        Value * genInlineConsField(ScmFunc * node, Value * obj, int32_t field);
+        Value * genInlineCompare(ScmFunc * node, const vector<Value*> & args, CmpInst::Predicate pred);
+
+        // Emits fast_expr if both arguments are fixnums and slow_expr
+        // (a runtime call) otherwise. The fast_expr gets the raw
+        // tagged words and may set an overflow flag. In that case the result
+        // is computed by slow_expr too.
+        template<typename F1, typename F2>
+        Value * genFixnumFastPath(const vector<Value*> & args, F1 fast_expr, F2 slow_expr) {
+            Function * func = builder.GetInsertBlock()->getParent();
+            Value * wa = builder.CreatePtrToInt(args[0], builder.getInt64Ty());
+            Value * wb = builder.CreatePtrToInt(args[1], builder.getInt64Ty());
+            Value * cond_val;
+            if (fixnum_vals.count(args[0]) && fixnum_vals.count(args[1])) {
+                // No tag check, the slow path is left for the overflow
+                cond_val = builder.getTrue();
+            }
+            else {
+                Value * tag_bits = builder.CreateAnd(builder.CreateAnd(wa, wb), FIXNUM_TAG);
+                cond_val = builder.CreateICmpNE(tag_bits, builder.getInt64(0));
+            }
+
+            BasicBlock * fast_bb = BasicBlock::Create(context, "fast", func);
+            BasicBlock * slow_bb = BasicBlock::Create(context, "slow");
+            BasicBlock * merge_bb = BasicBlock::Create(context, "merge");
+
+            builder.CreateCondBr(cond_val, fast_bb, slow_bb, genBranchWeights(2000, 1));
+
+            builder.SetInsertPoint(fast_bb);
+            Value * overflow = nullptr;
+            Value * fast_val = fast_expr(wa, wb, overflow);
+            if (overflow) {
+                builder.CreateCondBr(overflow, slow_bb, merge_bb, genBranchWeights(1, 2000));
+            }
+            else {
+                builder.CreateBr(merge_bb);
+            }
+            fast_bb = builder.GetInsertBlock();
+
+            func->getBasicBlockList().push_back(slow_bb);
+            builder.SetInsertPoint(slow_bb);
+            Value * slow_val = slow_expr();
+            builder.CreateBr(merge_bb);
+            slow_bb = builder.GetInsertBlock();
+
+            func->getBasicBlockList().push_back(merge_bb);
+            builder.SetInsertPoint(merge_bb);
+            PHINode * phi = builder.CreatePHI(t.scm_type_ptr, 2, "primres");
+            phi->addIncoming(fast_val, fast_bb);
+            phi->addIncoming(slow_val, slow_bb);
+
+            return phi;
+        }
+
+        void genSymbolInit(BasicBlock * bb);
         Value * genAndExpr(ScmCons * cell);
         Value * genOrExpr(ScmCons * cell);
 
@@ -243,12 +371,44 @@ namespace llscm {
 
         void run();
 
+        // Inline code of the primitive functions (see ScmFunc::genInline)
+        Value * genInline(ScmConsFunc * node, const vector<Value*> & args);
+        Value * genInline(ScmCarFunc * node, const vector<Value*> & args);
+        Value * genInline(ScmCdrFunc * node, const vector<Value*> & args);
+        Value * genInline(ScmNullFunc * node, const vector<Value*> & args);
+        Value * genInline(ScmPlusFunc * node, const vector<Value*> & args);
+        Value * genInline(ScmMinusFunc * node, const vector<Value*> & args);
+        Value * genInline(ScmTimesFunc * node, const vector<Value*> & args);
+        Value * genInline(ScmDivFunc * node, const vector<Value*> & args);
+        Value * genInline(ScmGtFunc * node, const vector<Value*> & args);
+        Value * genInline(ScmLtFunc * node, const vector<Value*> & args);
+        Value * genInline(ScmLeFunc * node, const vector<Value*> & args);
+        Value * genInline(ScmGeFunc * node, const vector<Value*> & args);
+        Value * genInline(ScmNumEqFunc * node, const vector<Value*> & args);
+        Value * genInline(ScmEqFunc * node, const vector<Value*> & args);
+        Value * genInline(ScmVecRefFunc * node, const vector<Value*> & args);
+
         void makeExecutable() {
             addEntryFuncProlog = &ScmCodeGen::addMainFuncProlog;
             addEntryFuncEpilog = &ScmCodeGen::addMainFuncEpilog;
             btype = BuildType::EXEC;
         }
 
+        void setOptLevel(unsigned level) {
+            optlevel = level;
+        }
+
+        // Runs the module pipeline selected by the optimization level
+        // (inlining, IPSCCP, LICM, GlobalDCE, ...). The target machine is optional,
+        // it provides the cost model for the vectorizers.
+        void optimizeModule(TargetMachine * tm = nullptr);
+        // The same for a module which wasn't generated by ScmCodeGen
+        static void optimizeModule(Module & mod, unsigned level, TargetMachine * tm = nullptr);
+
+        void useFlatClosures() {
+            flat_closures = true;
+        }
+
         void makeExpression(const string & name) {
             entry_func_name = name;
             addEntryFuncProlog = &ScmCodeGen::addExprFuncProlog;
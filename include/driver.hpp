@@ -3,6 +3,9 @@
 
 //#include <llvm/ADT/StringRef.h>
 
+#include <set>
+#include <vector>
+#include <llvm/Target/TargetMachine.h>
 #include "parser.hpp"
 
 namespace llscm {
@@ -13,6 +16,7 @@ namespace llscm {
 	extern char ** argv;
 
 	class Options;
+	class ScmCodeGen;
 
 	class Driver {
 		unique_ptr<Options> opts;
@@ -20,9 +24,14 @@ namespace llscm {
 		bool compileSourceFile(const string & fname);
 		bool compileString(const string & str);
 		bool compile(unique_ptr<Parser> && p);
-		void writeBitcodeToPipe(const shared_ptr<Module> & mod, FILE * pipe);
-		string getLLCompilerCommand();
-		bool invokeLLC(const shared_ptr<Module> & mod);
+		bool evalProgram(ScmProg & prog);
+		unique_ptr<ScmCodeGen> genCode(ScmProg & prog, bool exec);
+		bool collectLibraries(ScmProg & prog, set<string> & seen, vector<unique_ptr<Module>> & libs);
+		bool linkRequiredLibraries(Module & mod, ScmProg & prog);
+		unique_ptr<TargetMachine> createTargetMachine(const string & triple);
+		void importRuntimeBitcode(Module & mod);
+		bool emitOutput(const shared_ptr<Module> & mod, TargetMachine * tm, const string & out_fname);
+		bool emitStaticExecutable(const shared_ptr<Module> & mod, TargetMachine * tm);
 	public:
 		Driver(unique_ptr<Options> o) : opts(move(o)) {}
 		bool run();
@@ -36,11 +45,16 @@ namespace llscm {
 		};
 
 		enum Buildtype {
-			BT_EXEC, BT_LIB, BT_COUNT
+			BT_EXEC, BT_LIB, BT_WHOLE, BT_COUNT
+		};
+
+		enum Closures {
+			CL_CHAINED, CL_FLAT, CL_COUNT
 		};
 
 		static const char * ft_id[];
 		static const char * bt_id[];
+		static const char * cl_id[];
 
 		bool has_string_input;
 		bool has_output_name;
@@ -56,6 +70,12 @@ namespace llscm {
 		Buildtype buildtype;
 		// Optimization level
 		int optlevel;
+		// Closure representation
+		Closures closures;
+		// Save the bitcode for cross-module inlining
+		bool embed_bitcode;
+		// Link a static executable
+		bool static_link;
 
 	public:
 		bool invalid;
@@ -66,6 +86,9 @@ namespace llscm {
 			filetype = FT_OBJ;
 			buildtype = BT_EXEC;
 			optlevel = 0;
+			closures = CL_CHAINED;
+			embed_bitcode = false;
+			static_link = false;
 			has_output_name = false;
 		}
 
@@ -83,7 +106,9 @@ namespace llscm {
 				// Set the default output name
 				// derived from the input name
 				out_fname = StringRef(in_fname).drop_back(4);
-				out_fname += ".o";
+				if (!static_link) {
+					out_fname += ".o";
+				}
 				has_output_name = true;
 			}
 
@@ -120,6 +145,39 @@ namespace llscm {
 			optlevel = atoi(str.c_str());
 			return *this;
 		}
+
+		Options & setEmbedBitcode() {
+			embed_bitcode = true;
+			return *this;
+		}
+
+		// Must be set before the input, the default output name is the executable
+		Options & setStaticLink() {
+			static_link = true;
+			return *this;
+		}
+
+		// A static executable has the required libraries linked in (whole program build)
+		bool resolveStaticLink() {
+			if (!static_link) {
+				return true;
+			}
+			if (buildtype == BT_LIB || filetype != FT_OBJ) {
+				return false;
+			}
+			buildtype = BT_WHOLE;
+			return true;
+		}
+
+		Options & setClosures(const string & str) {
+			for (int i = 0; i < CL_COUNT; i++) {
+				if (str == cl_id[i]) {
+					closures = (Closures)i;
+					break;
+				}
+			}
+			return *this;
+		}
 	};
 }
 
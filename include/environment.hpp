@@ -7,12 +7,21 @@
 #include "ast.hpp"
 #include "parser.hpp"
 #include "libmetainfo.hpp"
+#include "lib_reader.hpp"
 
 namespace llscm {
     using namespace std;
 
     typedef shared_ptr<pair<int, ScmFunc*>> ScmLoc;
 
+    // Functions and globals exported by a library.
+    // They are bound in the environment when they're referenced for the first time.
+    struct LibExports {
+        // Keeps the library mapped if the metadata is read from the file
+        LibReader reader;
+        Metadata meta;
+    };
+
     class ScmNameGen {
         unordered_map<string, uint32_t> uniq_id;
     public:
@@ -24,6 +33,12 @@ namespace llscm {
         ScmEnv * top_level_env;
         unordered_map<ScmSym, P_ScmObj> binding;
         ScmNameGen namegen;
+        // Changed with every global binding, unique among all environments
+        uint64_t generation;
+        void nextGeneration();
+        // Required libraries, the last one is searched first
+        vector<shared_ptr<LibExports>> libs;
+        P_ScmObj importExport(ScmSym * sym);
     public:
         static int GlobalLevel;
         ScmProg * prog;
@@ -50,6 +65,8 @@ namespace llscm {
         ScmFunc * defInFunc();
         bool set(P_ScmObj k, P_ScmObj obj);
         bool set(const string & k, P_ScmObj obj);
+        // Names not bound in the top-level environment are looked up in lib
+        void addLibrary(shared_ptr<LibExports> lib);
         void error(const string & msg);
         bool fail() {
             return err_flag;
@@ -57,6 +74,11 @@ namespace llscm {
         bool isGlobal() {
             return this == top_level_env;
         }
+        // Code compiled in this environment stays valid
+        // as long as the generation doesn't change
+        uint64_t getGeneration() {
+            return top_level_env->generation;
+        }
         // This method has to be run on the environment in case
         // we want to use it again to compile different program.
         // Otherwise it would still contain references to the
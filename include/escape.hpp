@@ -0,0 +1,49 @@
+#ifndef LLSCHEME_ESCAPE_HPP
+#define LLSCHEME_ESCAPE_HPP
+
+#include <unordered_map>
+#include <vector>
+#include "ast.hpp"
+
+namespace llscm {
+    using namespace std;
+
+    // Reference to a function or variable and the way it's used.
+    // Arguments of direct calls are the only uses which may keep the value local.
+    struct RefUse {
+        ScmRef * ref;
+        // Call which takes the reference as an argument (or as the callee)
+        ScmCall * call;
+        // -1 for the function expression of the call
+        int32_t arg_idx;
+    };
+
+    // Collects references in expr and the way they are used.
+    // Nested functions are only added to funcs, their bodies are not visited.
+    void collectUses(ScmObj * expr, vector<RefUse> & uses, vector<ScmFunc*> & funcs);
+
+    // Escape analysis of closure data. A closure object (and the heap storage
+    // it points to) doesn't escape when it's only passed to the parameters
+    // which are called or passed on to other non-escaping parameters.
+    class EscapeInfo {
+        unordered_map<ScmFunc*, vector<RefUse>> body_uses;
+        unordered_map<ScmFunc*, vector<bool>> param_escapes;
+        // Parameter object -> its function and index
+        unordered_map<ScmObj*, pair<ScmFunc*, int32_t>> params;
+
+        void addFunc(ScmFunc * func, vector<ScmFunc*> & worklist);
+        bool argEscapes(ScmCall * call, int32_t idx);
+    public:
+        // Computes the parameter escape flags of all the functions defined in prog.
+        // Parameters of the functions from other modules escape unless
+        // the library metadata says otherwise (ScmFunc::noescape_args).
+        void analyze(ScmObj * prog);
+        // Non-escaping parameters of func as a bit mask (saved in the metadata)
+        uint32_t noEscapeMask(ScmFunc * func);
+        // Heap storage of func and the closure objects created by func
+        // don't outlive its activation. Expects the tail calls to be marked.
+        bool stackAllocClosures(ScmFunc * func);
+    };
+}
+
+#endif //LLSCHEME_ESCAPE_HPP
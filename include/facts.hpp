@@ -0,0 +1,13 @@
+#ifndef LLSCHEME_FACTS_HPP
+#define LLSCHEME_FACTS_HPP
+
+#include "ast.hpp"
+
+namespace llscm {
+    // Computes the FunctionFact flags (libmetainfo.hpp) of the functions
+    // defined in prog and saves them to ScmFunc::facts. Recursive functions
+    // are handled optimistically (the flags are only removed until nothing changes).
+    void computeFacts(ScmObj * prog);
+}
+
+#endif //LLSCHEME_FACTS_HPP
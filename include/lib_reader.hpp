@@ -1,20 +1,24 @@
 #ifndef LLSCHEME_LIB_READER_HPP
 #define LLSCHEME_LIB_READER_HPP
 
+#include <cstddef>
 #include <string>
 #include <memory>
 
 namespace llscm {
     class LibReader {
         struct Impl;
-        // We have to use pimpl in order to avoid including elfio/elfio.hpp here.
+        // We have to use pimpl in order to avoid including elf.h here.
         // There is a collision with LLVM in some global enums and #defines.
         std::unique_ptr<Impl> impl;
     public:
         LibReader();
         ~LibReader();
+        // Maps the library into memory (the returned symbols point into the mapping)
         bool load(const std::string & libname);
-        void * getAddressOfSymbol(const std::string & symname);
+        // Uses the .gnu.hash or .hash section of the library if there is one.
+        // Optionally returns the size of the symbol (e.g. an array)
+        void * getAddressOfSymbol(const std::string & symname, size_t * size = nullptr);
     };
 }
 
@@ -4,58 +4,88 @@
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <string>
 #include <vector>
 
 namespace llscm {
     using namespace std;
 
-    // TODO: We also need global variables in the Metadata structure
-    struct __attribute__ ((__packed__)) FunctionInfo {
-        int32_t argc;
-        char name[1];
-
-        void * operator new(std::size_t s, void * p, int32_t namelen);
-
-        // Disable default new
-        void * operator new(std::size_t s) = delete;
-        void * operator new(std::size_t s, void * p) = delete;
+    // Facts about a compiled function which hold for any call
+    enum FunctionFact: uint32_t {
+        // Returns #t or #f
+        FN_RET_BOOL = 1 << 0,
+        // Returns a fixnum
+        FN_RET_FIXNUM = 1 << 1
+    };
 
-        FunctionInfo(int32_t argc, const char * name);
+    /*
+     * Library metadata saved in the __llscheme_metainfo__ array:
+     * header, function records, global records and the string table.
+     * The records have fixed size and are sorted by name,
+     * so the blob can be searched in place (from the mapped library).
+     */
+    struct MetaHeader {
+        char magic[12];
+        uint32_t version;
+        uint32_t func_count;
+        uint32_t global_count;
+        uint32_t strtab_size;
+    };
 
-        static size_t size(size_t namelen);
+    struct FunctionInfo {
+        // Offset of the name in the string table
+        uint32_t name;
+        int32_t argc;
+        uint32_t facts;
+        // Bit i is set if argument i doesn't escape (see escape.hpp)
+        uint32_t noescape;
+    };
 
-        size_t size();
+    struct GlobalInfo {
+        uint32_t name;
+        uint32_t flags;
     };
 
-    struct Metadata {
-        uint8_t * metadata;
-        size_t md_size;
-        size_t alloc_size;
-        static const size_t InitSize;
+    // Read-only view of the metadata blob (nothing is copied)
+    class Metadata {
+        const uint8_t * blob;
+        const MetaHeader * hdr;
+        const FunctionInfo * funcs;
+        const GlobalInfo * globals;
+        const char * strtab;
+    public:
         static const char magic[];
+        static const uint32_t Version;
 
-        Metadata();
-        ~Metadata();
+        Metadata(): blob(nullptr), hdr(nullptr), funcs(nullptr), globals(nullptr), strtab(nullptr) {}
 
-        FunctionInfo * addRecord(int32_t argc, const string & name);
+        // Checks the header (and the blob size if it's known)
+        bool loadFromBlob(const void * data, size_t size = 0);
 
-        template<typename F>
-        void foreachRecord(F func) {
-            uint8_t * arr_ptr = metadata + strlen(magic);
-            FunctionInfo * rec;
-
-            while (true) {
-                rec = (FunctionInfo*)arr_ptr;
-                if (!rec->name[0]) break;
-
-                func(rec);
-
-                arr_ptr += rec->size();
-            }
+        const char * name(const FunctionInfo & rec) const {
+            return strtab + rec.name;
         }
+        const char * name(const GlobalInfo & rec) const {
+            return strtab + rec.name;
+        }
+
+        // Binary search in the sorted records (used for the lazy import, see ScmEnv)
+        const FunctionInfo * findFunction(const char * fname) const;
+        const GlobalInfo * findGlobal(const char * gname) const;
+    };
 
+    // Collects the records during code generation
+    class MetadataBuilder {
+        struct Record {
+            string name;
+            FunctionInfo info;
+        };
+        vector<Record> funcs;
+        vector<string> globals;
+    public:
+        void addFunction(const string & name, int32_t argc, uint32_t facts, uint32_t noescape);
+        void addGlobal(const string & name);
         vector<uint8_t> getBlob();
-        bool loadFromBlob(void * blob);
     };
 }
 
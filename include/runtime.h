@@ -5,7 +5,6 @@
 #include <set>
 #include <cstdio>
 #include "runtime/types.hpp"
-#include "runtime/scmjit.hpp"
 
 #define SCM_NULL &(Constant::scm_null)
 #define SCM_TRUE &(Constant::scm_true)
@@ -20,14 +19,6 @@ namespace llscm {
         class LibSetup {
         public:
             LibSetup();
-            ~LibSetup();
-        };
-
-        class InitJIT {
-            std::unique_ptr<llvm::orc::ScmJIT> jit;
-        public:
-            InitJIT();
-            llvm::orc::ScmJIT * getJIT();
         };
 
         struct scm_type_t {
@@ -96,6 +87,18 @@ namespace llscm {
             FILE * handle;
         };
 
+        inline bool is_fixnum(const scm_type_t * obj) {
+            return ((uintptr_t)obj & FIXNUM_TAG) != 0;
+        }
+
+        inline scm_type_t * make_fixnum(int64_t value) {
+            return (scm_type_t*)(((uintptr_t)value << FIXNUM_SHIFT) | FIXNUM_TAG);
+        }
+
+        inline int64_t fixnum_value(const scm_type_t * obj) {
+            return (intptr_t)obj >> FIXNUM_SHIFT;
+        }
+
         struct Constant {
             static scm_type_t scm_null;
             static scm_type_t scm_true;
@@ -124,6 +127,16 @@ namespace llscm {
                 return asType;
             }
 
+            // Fixnums have no header, so the tag must not be
+            // read through the pointer before checking for them.
+            int32_t tag() const {
+                return is_fixnum(asType) ? S_INT : asType->tag;
+            }
+
+            int64_t intValue() const {
+                return is_fixnum(asType) ? fixnum_value(asType) : asInt->value;
+            }
+
             scm_ptr_t() {
                 asType = SCM_NULL;
             }
@@ -149,7 +162,9 @@ namespace llscm {
             extern int32_t exit_code;
             extern scm_type_t * scm_argv;
 
-            extern scm_type_t * zip(scm_ptr_t a, scm_ptr_t b);
+            // Implemented in scmlib. Compiled Scheme functions use fastcc,
+            // C code has to call them through their argument list wrapper.
+            extern scm_type_t * argl_zip(scm_type_t ** arg_list);
 
             scm_type_t * scm_get_arg_vector(int argc, char * argv[]);
             //scm_type_t * scm_cmd_args();
@@ -158,6 +173,9 @@ namespace llscm {
             DECL_WITH_WRAPPER(scm_display, scm_ptr_t obj); // TODO: also implement print
             //scm_type_t * scm_gt(scm_ptr_t a, scm_ptr_t b);
             DECL_WITH_WRAPPER(scm_gt, scm_ptr_t a, scm_ptr_t b);
+            DECL_WITH_WRAPPER(scm_lt, scm_ptr_t a, scm_ptr_t b);
+            DECL_WITH_WRAPPER(scm_le, scm_ptr_t a, scm_ptr_t b);
+            DECL_WITH_WRAPPER(scm_ge, scm_ptr_t a, scm_ptr_t b);
             //scm_type_t * scm_num_eq(scm_ptr_t a, scm_ptr_t b);
             DECL_WITH_WRAPPER(scm_num_eq, scm_ptr_t a, scm_ptr_t b);
             //scm_type_t * scm_cons(scm_ptr_t car, scm_ptr_t cdr);
@@ -181,6 +199,12 @@ namespace llscm {
             //scm_type_t * scm_div(scm_type_t * arg0, ...);
             DECL_WITH_WRAPPER(scm_div, scm_type_t * arg0, ...);
 
+            // Two argument variants of the arithmetic functions
+            scm_type_t * scm_plus2(scm_type_t * a, scm_type_t * b);
+            scm_type_t * scm_minus2(scm_type_t * a, scm_type_t * b);
+            scm_type_t * scm_times2(scm_type_t * a, scm_type_t * b);
+            scm_type_t * scm_div2(scm_type_t * a, scm_type_t * b);
+
             // Note: length does not have to be a native function
             // we can define it in scheme like this:
             // (define (length a) (if (null? a) 0 (+ 1 (length (cdr a)))))
@@ -194,6 +218,8 @@ namespace llscm {
 
             DECL_WITH_WRAPPER(scm_eval, scm_ptr_t expr, scm_ptr_t ns);
 
+            DECL_WITH_WRAPPER(scm_eval_batch, scm_ptr_t exprs, scm_ptr_t ns);
+
             DECL_WITH_WRAPPER(scm_read);
 
             DECL_WITH_WRAPPER(scm_is_eof, scm_ptr_t obj);
@@ -216,11 +242,15 @@ namespace llscm {
 
             DECL_WITH_WRAPPER(scm_read_line, scm_ptr_t port);
 
+            DECL_WITH_WRAPPER(scm_eq, scm_ptr_t a, scm_ptr_t b);
+
             DECL_WITH_WRAPPER(scm_equal, scm_ptr_t a, scm_ptr_t b);
 
             DECL_WITH_WRAPPER(scm_exit, scm_ptr_t code);
 
             DECL_WITH_WRAPPER(scm_random, scm_ptr_t k);
+
+            DECL_WITH_WRAPPER(scm_collect_garbage);
         }
     }
 }
@@ -0,0 +1,79 @@
+#ifndef LLSCHEME_COMPILE_SERVICE_HPP
+#define LLSCHEME_COMPILE_SERVICE_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <llvm/IR/Module.h>
+#include <llvm/Object/ObjectFile.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
+
+namespace llscm {
+    namespace runtime {
+        using namespace std;
+        using namespace llvm;
+
+        /*
+         * Optimizes and compiles the eval'd modules to objects on worker threads.
+         * The module is generated by the calling thread (the AST and the namespace
+         * aren't shared), the workers get its bitcode and parse it into their own
+         * LLVM contexts. The objects are added to the JIT by the calling thread.
+         * The objects found in the DiskObjectCache aren't compiled at all.
+         */
+        class CompileService {
+        public:
+            typedef object::OwningBinary<object::ObjectFile> Object;
+            // Null if the compilation failed
+            typedef shared_future<shared_ptr<Object>> ObjectFuture;
+
+            CompileService(TargetOptions opts, unsigned opt_level);
+            // Waits for the running compilations, the queued ones are dropped
+            ~CompileService();
+
+            // LLSCHEME_JIT_THREADS=<n> (one per core by default),
+            // 0 means that everything is compiled by the calling thread
+            static unsigned threadCount();
+
+            // The future is ready at once if the object was cached
+            ObjectFuture submit(Module & mod);
+            // On the calling thread, the module is optimized in place.
+            // The modules freed after one use aren't worth the disk cache.
+            shared_ptr<Object> compile(Module & mod, bool use_cache = true);
+
+            static bool isReady(const ObjectFuture & object) {
+                return object.wait_for(chrono::seconds(0)) == future_status::ready;
+            }
+        private:
+            struct Job {
+                SmallVector<char, 0> bitcode;
+                // Identifier of the module (its cache key)
+                string name;
+                promise<shared_ptr<Object>> result;
+            };
+
+            TargetOptions options;
+            unsigned opt_level;
+            // Used by the calling thread
+            unique_ptr<TargetMachine> local_tm;
+            // Part of the cache keys
+            string target;
+            vector<thread> workers;
+            mutex lock;
+            condition_variable cond;
+            deque<unique_ptr<Job>> queue;
+            bool stopping;
+
+            void work();
+            shared_ptr<Object> compile(Job & job, TargetMachine & tm);
+            shared_ptr<Object> compileModule(Module & mod, TargetMachine & tm);
+            shared_ptr<Object> findCached(Module & mod, StringRef bitcode);
+        };
+    }
+}
+
+#endif //LLSCHEME_COMPILE_SERVICE_HPP
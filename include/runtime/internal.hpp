@@ -43,10 +43,10 @@ namespace llscm {
 
             while (obj.asType != nullptr) {
                 if (is_int) {
-                    if (obj->tag == S_INT) {
-                        sum += obj.asInt->value;
+                    if (obj.tag() == S_INT) {
+                        sum += obj.intValue();
                     }
-                    else if (obj->tag == S_FLOAT) {
+                    else if (obj.tag() == S_FLOAT) {
                         fsum = sum + obj.asFloat->value;
                         is_int = false;
                     }
@@ -55,10 +55,10 @@ namespace llscm {
                     }
                 }
                 else {
-                    if (obj->tag == S_INT) {
-                        fsum += obj.asInt->value;
+                    if (obj.tag() == S_INT) {
+                        fsum += obj.intValue();
                     }
-                    else if (obj->tag == S_FLOAT) {
+                    else if (obj.tag() == S_FLOAT) {
                         fsum += obj.asFloat->value;
                     }
                     else {
@@ -89,10 +89,10 @@ namespace llscm {
             }
 
             //obj = va_arg(ap, scm_type_t*);
-            if (obj->tag == S_INT) {
-                diff = obj.asInt->value;
+            if (obj.tag() == S_INT) {
+                diff = obj.intValue();
             }
-            else if (obj->tag == S_FLOAT) {
+            else if (obj.tag() == S_FLOAT) {
                 fdiff = obj.asFloat->value;
                 is_int = false;
             }
@@ -110,10 +110,10 @@ namespace llscm {
 
             while (obj.asType != nullptr) {
                 if (is_int) {
-                    if (obj->tag == S_INT) {
-                        diff -= obj.asInt->value;
+                    if (obj.tag() == S_INT) {
+                        diff -= obj.intValue();
                     }
-                    else if (obj->tag == S_FLOAT) {
+                    else if (obj.tag() == S_FLOAT) {
                         fdiff = diff - obj.asFloat->value;
                         is_int = false;
                     }
@@ -122,10 +122,10 @@ namespace llscm {
                     }
                 }
                 else {
-                    if (obj->tag == S_INT) {
-                        fdiff -= obj.asInt->value;
+                    if (obj.tag() == S_INT) {
+                        fdiff -= obj.intValue();
                     }
-                    else if (obj->tag == S_FLOAT) {
+                    else if (obj.tag() == S_FLOAT) {
                         fdiff -= obj.asFloat->value;
                     }
                     else {
@@ -150,10 +150,10 @@ namespace llscm {
 
             while (obj.asType != nullptr) {
                 if (is_int) {
-                    if (obj->tag == S_INT) {
-                        prod *= obj.asInt->value;
+                    if (obj.tag() == S_INT) {
+                        prod *= obj.intValue();
                     }
-                    else if (obj->tag == S_FLOAT) {
+                    else if (obj.tag() == S_FLOAT) {
                         fprod = prod * obj.asFloat->value;
                         is_int = false;
                     }
@@ -162,10 +162,10 @@ namespace llscm {
                     }
                 }
                 else {
-                    if (obj->tag == S_INT) {
-                        fprod *= obj.asInt->value;
+                    if (obj.tag() == S_INT) {
+                        fprod *= obj.intValue();
                     }
-                    else if (obj->tag == S_FLOAT) {
+                    else if (obj.tag() == S_FLOAT) {
                         fprod *= obj.asFloat->value;
                     }
                     else {
@@ -192,10 +192,10 @@ namespace llscm {
             }
 
             //obj = va_arg(ap, scm_type_t*);
-            if (obj->tag == S_INT) {
-                fquot = obj.asInt->value;
+            if (obj.tag() == S_INT) {
+                fquot = obj.intValue();
             }
-            else if (obj->tag == S_FLOAT) {
+            else if (obj.tag() == S_FLOAT) {
                 fquot = obj.asFloat->value;
             }
             else {
@@ -208,10 +208,10 @@ namespace llscm {
             }
 
             while (obj.asType != nullptr) {
-                if (obj->tag == S_INT) {
-                    fquot /= obj.asInt->value;
+                if (obj.tag() == S_INT) {
+                    fquot /= obj.intValue();
                 }
-                else if (obj->tag == S_FLOAT) {
+                else if (obj.tag() == S_FLOAT) {
                     fquot /= obj.asFloat->value;
                 }
                 else {
@@ -261,7 +261,7 @@ namespace llscm {
                 WRONG_ARG_NUM();
             }
 
-            if (arg0->tag != S_NSPACE) {
+            if (scm_ptr_t(arg0).tag() != S_NSPACE) {
                 INVALID_ARG_TYPE();
             }
 
@@ -272,8 +272,8 @@ namespace llscm {
         template<typename F>
         void list_foreach(scm_ptr_t list, F func) {
             scm_ptr_t cell = list;
-            while(cell->tag != S_NIL) {
-                assert(cell->tag == S_CONS);
+            while(cell.tag() != S_NIL) {
+                assert(cell.tag() == S_CONS);
 
                 func(cell);
                 cell = cell.asCons->cdr;
@@ -0,0 +1,103 @@
+#ifndef LLSCHEME_INTERP_HPP
+#define LLSCHEME_INTERP_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <llvm/IR/Module.h>
+#include "../ast.hpp"
+#include "../runtime.h"
+
+namespace llscm {
+    namespace runtime {
+        using namespace std;
+        using namespace llvm;
+
+        /*
+         * Tier 0 of eval: walks the AST after CT_Eval instead of compiling it.
+         * Most of the eval'd expressions run once or twice, the LLVM compilation
+         * would take much longer than the evaluation itself.
+         *
+         * Interpreted code works with the same objects as the compiled code.
+         * Globals are accessed by their exported names (see findGlobal),
+         * closures are ordinary scm_func objects whose function pointers
+         * lead back to the interpreter (through small compiled entry points).
+         * Hot closures are compiled and the interpreter forwards their calls.
+         */
+        class Interpreter {
+        public:
+            // Compiles the program in the environment, returns its expression function
+            typedef function<scm_expr_ptr_t(ScmProg &, P_ScmEnv)> Compiler;
+            // Address of a symbol defined by the compiled code or by the process
+            typedef function<void*(const string &)> Resolver;
+            // Adds a module to the JIT
+            typedef function<void(shared_ptr<Module>)> Loader;
+
+            // Evaluations of the same expression before it gets compiled
+            static const uint32_t ExprJitThreshold = 2;
+            // Calls of an interpreted closure before it gets compiled
+            static const uint32_t FuncJitThreshold = 1000;
+            // Closures with more arguments make the expression compiled
+            static const int32_t MaxArgs = 8;
+
+            Interpreter(Compiler comp, Resolver res, Loader load);
+            ~Interpreter();
+
+            // LLSCHEME_INTERP=0 disables the interpreter
+            static bool enabled();
+            // Anything the interpreter doesn't handle is left to the JIT
+            static bool canInterpret(ScmProg & prog);
+
+            scm_type_t * run(shared_ptr<ScmProg> prog, P_ScmEnv env);
+
+            // Cells of the globals defined by interpreted code,
+            // the JIT resolves the compiled references to them
+            scm_type_t ** findGlobal(const string & name);
+            // The module's definitions replace those of the interpreter
+            void forgetGlobals(Module & mod);
+
+            // Called by the entry points (arguments followed by the context pointer)
+            scm_type_t * apply(scm_type_t ** args, int32_t argc);
+        private:
+            struct Program;
+            struct Lambda;
+            // Frame: parent, owner function, number of bindings, (key, value) pairs
+            typedef scm_type_t ** Frame;
+
+            struct FuncAddr {
+                scm_fnptr_t fnptr;
+                al_wrapper_t wrfnptr;
+            };
+
+            Compiler compile;
+            Resolver resolve;
+            Loader load;
+            unordered_map<string, scm_type_t**> globals;
+            scm_fnptr_t entry_fn[MaxArgs + 1];
+            al_wrapper_t entry_wrfn[MaxArgs + 1];
+            bool have_entries;
+
+            void genEntries();
+            scm_type_t ** globalCell(Program * prog, ScmObj * obj);
+            const FuncAddr & funcAddress(Program * prog, ScmFunc * fn);
+            Lambda * getLambda(Program * prog, ScmFunc * fn);
+            Lambda * asLambda(scm_func_t * func);
+            bool isHot(Lambda * lambda);
+            bool promote(Lambda * lambda);
+            bool prepareCompile(ScmObj * node, unordered_set<ScmFunc*> & seen);
+
+            scm_type_t * eval(Program * prog, ScmObj * node, Frame env);
+            ScmObj * evalBody(Program * prog, P_ScmObj & body, Frame & env);
+            void evalDefine(Program * prog, ScmDefineVarSyntax * def, Frame & env);
+            scm_type_t * evalRef(Program * prog, ScmRef * ref, Frame env);
+            Frame evalArgs(Program * prog, ScmFunc * fn, P_ScmObj & arg_list, Frame env, Frame parent);
+            scm_type_t * makeFunc(Program * prog, ScmFunc * fn, Frame env);
+        };
+    }
+}
+
+#endif //LLSCHEME_INTERP_HPP
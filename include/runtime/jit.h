@@ -0,0 +1,21 @@
+#ifndef LLSCHEME_JIT_H
+#define LLSCHEME_JIT_H
+
+#include "../runtime.h"
+
+// The compiler part of the runtime (eval, read) is built as a separate
+// library. The core runtime loads it with dlopen when it's first needed.
+#define LLSCMJIT_LIB "libllscmjit.so"
+
+namespace llscm {
+    namespace runtime {
+        extern "C" {
+            scm_type_t * jit_make_base_nspace();
+            scm_type_t * jit_eval(scm_type_t * expr, scm_type_t * ns);
+            scm_type_t * jit_eval_batch(scm_type_t * exprs, scm_type_t * ns);
+            scm_type_t * jit_read();
+        }
+    }
+}
+
+#endif //LLSCHEME_JIT_H
@@ -3,7 +3,9 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <iostream>
 #include "../runtime.h"
+#include "../debug.hpp"
 #include "gc_cpp.h"
 
 namespace llscm {
@@ -50,14 +52,14 @@ namespace llscm {
         template<class C>
         std::shared_ptr<bool> GCed<C>::anchor = std::make_shared<bool>(true);
 
-        void mem_cleanup();
-
         extern "C" {
             scm_type_t * alloc_int(int64_t value);
             scm_type_t * alloc_float(double value);
             scm_type_t * alloc_vec(int32_t size);
             scm_type_t * alloc_str(const char * str);
             scm_type_t * alloc_sym(const char * sym);
+            scm_type_t * intern_static_sym(scm_type_t * sym);
+            scm_type_t * alloc_pinned_sym(const char * sym);
             scm_type_t * alloc_func(int32_t argc, scm_fnptr_t fnptr,
                                     al_wrapper_t wrfnptr, scm_type_t ** ctxptr);
             scm_type_t * alloc_cons(scm_type_t * car, scm_type_t * cdr);
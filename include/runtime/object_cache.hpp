@@ -0,0 +1,43 @@
+#ifndef LLSCHEME_OBJECT_CACHE_HPP
+#define LLSCHEME_OBJECT_CACHE_HPP
+
+#include <memory>
+#include <string>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/ExecutionEngine/ObjectCache.h>
+#include <llvm/IR/Module.h>
+#include <llvm/Support/MemoryBuffer.h>
+
+namespace llscm {
+    namespace runtime {
+        using namespace std;
+        using namespace llvm;
+
+        /*
+         * Keeps the objects compiled from the eval'd modules in a directory
+         * (LLSCHEME_JIT_CACHE=<dir>, disabled by default or with 0),
+         * so that the next process evaluating the same code doesn't compile it again.
+         * Only the modules named by cacheKey are stored, one file per key.
+         */
+        class DiskObjectCache : public ObjectCache {
+        public:
+            // Null if the cache is disabled or the directory can't be created
+            static DiskObjectCache * get();
+
+            // Hash of the unoptimized bitcode, the target, the optimization level
+            // and the build of the runtime and compiler libraries
+            static string cacheKey(StringRef bitcode, StringRef target, unsigned opt_level);
+
+            unique_ptr<MemoryBuffer> getObject(const Module * mod) override;
+            void notifyObjectCompiled(const Module * mod, MemoryBufferRef obj) override;
+        private:
+            string dir;
+
+            DiskObjectCache(string dir): dir(move(dir)) {}
+            // False if the module wasn't named by cacheKey
+            bool objectPath(const Module * mod, SmallVectorImpl<char> & path) const;
+        };
+    }
+}
+
+#endif //LLSCHEME_OBJECT_CACHE_HPP
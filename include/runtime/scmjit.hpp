@@ -19,63 +19,238 @@
 
 #include <llvm/ExecutionEngine/ExecutionEngine.h>
 #include <llvm/ExecutionEngine/RTDyldMemoryManager.h>
+#include <llvm/ExecutionEngine/SectionMemoryManager.h>
+#include <llvm/ExecutionEngine/Orc/CompileOnDemandLayer.h>
 #include <llvm/ExecutionEngine/Orc/CompileUtils.h>
 #include <llvm/ExecutionEngine/Orc/IRCompileLayer.h>
+#include <llvm/ExecutionEngine/Orc/IRTransformLayer.h>
+#include <llvm/ExecutionEngine/Orc/IndirectionUtils.h>
 #include <llvm/ExecutionEngine/Orc/LambdaResolver.h>
 #include <llvm/ExecutionEngine/Orc/ObjectLinkingLayer.h>
+#include <llvm/ExecutionEngine/Orc/OrcArchitectureSupport.h>
 #include <llvm/IR/Mangler.h>
+#include <llvm/Object/ObjectFile.h>
 #include <llvm/Support/DynamicLibrary.h>
 #include <llvm/Support/TargetSelect.h>
+#include <cstdlib>
 #include <iostream>
+#include <functional>
+#include <set>
+#include <unordered_map>
 #include "../debug.hpp"
 
 namespace llvm {
     namespace orc {
 
+        // Remembers the address ranges of the sections it allocates,
+        // so that we can tell whether an object lives in a module.
+        class TrackingMemoryManager : public SectionMemoryManager {
+        public:
+            typedef std::vector<std::pair<uint64_t, uint64_t>> SectionRangesT;
+
+            TrackingMemoryManager(std::shared_ptr<SectionRangesT> Ranges)
+                    : Ranges(std::move(Ranges)) {}
+
+            uint8_t *allocateCodeSection(uintptr_t Size, unsigned Alignment, unsigned SectionID,
+                                         StringRef SectionName) override {
+                uint8_t *Addr = SectionMemoryManager::allocateCodeSection(
+                        Size, Alignment, SectionID, SectionName);
+                Ranges->emplace_back((uint64_t)Addr, (uint64_t)Addr + Size);
+                return Addr;
+            }
+
+            uint8_t *allocateDataSection(uintptr_t Size, unsigned Alignment, unsigned SectionID,
+                                         StringRef SectionName, bool IsReadOnly) override {
+                uint8_t *Addr = SectionMemoryManager::allocateDataSection(
+                        Size, Alignment, SectionID, SectionName, IsReadOnly);
+                Ranges->emplace_back((uint64_t)Addr, (uint64_t)Addr + Size);
+                return Addr;
+            }
+
+        private:
+            std::shared_ptr<SectionRangesT> Ranges;
+        };
+
         class ScmJIT {
         public:
+            typedef TrackingMemoryManager::SectionRangesT SectionRangesT;
+            typedef object::OwningBinary<object::ObjectFile> ObjectT;
             typedef ObjectLinkingLayer<> ObjLayerT;
             typedef IRCompileLayer<ObjLayerT> CompileLayerT;
-            typedef CompileLayerT::ModuleSetHandleT ModuleHandleT;
+            typedef std::function<std::unique_ptr<Module>(std::unique_ptr<Module>)> OptimizeFtor;
+            typedef IRTransformLayer<CompileLayerT, OptimizeFtor> OptimizeLayerT;
+            typedef CompileOnDemandLayer<OptimizeLayerT> CODLayerT;
 
-            ScmJIT()
-                    : TM(EngineBuilder().selectTarget()), DL(TM->createDataLayout()),
-                      CompileLayer(ObjectLayer, SimpleCompiler(*TM)) {
+            // The eager and the lazy modules are kept by different layers
+            struct ModuleHandleT {
+                bool Lazy;
+                // The same type as the handles of ObjectLayer (see addObject)
+                CompileLayerT::ModuleSetHandleT EagerH;
+                CODLayerT::ModuleSetHandleT LazyH;
+
+                bool operator==(const ModuleHandleT &Other) const {
+                    if (Lazy != Other.Lazy)
+                        return false;
+                    return Lazy ? LazyH == Other.LazyH : EagerH == Other.EagerH;
+                }
+            };
+
+            // In the lazy mode, the module gets only stubs at addModule
+            // and each function is compiled on its first call.
+            ScmJIT(bool LazyMode = false)
+                    : TM(EngineBuilder().setTargetOptions(getTargetOptions()).selectTarget()),
+                      DL(TM->createDataLayout()),
+                      CompileLayer(ObjectLayer, SimpleCompiler(*TM)),
+                      OptimizeLayer(CompileLayer,
+                                    [this](std::unique_ptr<Module> M) {
+                                        if (PartitionOptimizer)
+                                            PartitionOptimizer(*M);
+                                        return M;
+                                    }),
+                      Lazy(LazyMode) {
                 llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+                // The eager mode doesn't need the stubs and the callbacks
+                if (Lazy) {
+                    CompileCallbackMgr = llvm::make_unique<LocalJITCompileCallbackManager<OrcX86_64>>(
+                            static_cast<TargetAddress>(reinterpret_cast<uintptr_t>(&lazyCompileError)));
+                    CODLayer = llvm::make_unique<CODLayerT>(
+                            OptimizeLayer,
+                            [](Function &F) { return std::set<Function*>({&F}); },
+                            *CompileCallbackMgr,
+                            []() { return llvm::make_unique<LocalIndirectStubsManager<OrcX86_64>>(); });
+                }
             }
 
+            bool isLazy() const { return Lazy; }
+
             TargetMachine &getTargetMachine() { return *TM; }
 
             ModuleHandleT addModule(std::shared_ptr<Module> M) {
-                // We need a memory manager to allocate memory and resolve symbols for this
-                // new module. Create one that resolves symbols by looking back into the
-                // JIT.
-                auto Resolver = createLambdaResolver(
-                        [&](const std::string &Name) {
-                            if (auto Sym = findMangledSymbol(Name))
-                                return RuntimeDyld::SymbolInfo(Sym.getAddress(), Sym.getFlags());
-                            return RuntimeDyld::SymbolInfo(nullptr);
-                        },
-                        [](const std::string &S) { return nullptr; });
-                auto H = CompileLayer.addModuleSet(singletonSet(std::move(M)),
-                                                   make_unique<SectionMemoryManager>(),
-                                                   std::move(Resolver));
+                auto Resolver = createResolver();
+                std::vector<std::string> Symbols = definedSymbols(*M);
+                std::shared_ptr<SectionRangesT> Sections;
+                ModuleHandleT H;
+                H.Lazy = Lazy;
+                if (Lazy)
+                    H.LazyH = CODLayer->addModuleSet(singletonSet(std::move(M)),
+                                                     make_unique<SectionMemoryManager>(),
+                                                     std::move(Resolver));
+                else {
+                    // The lazy partitions get their own memory managers, we track the eager modules only
+                    Sections = std::make_shared<SectionRangesT>();
+                    H.EagerH = CompileLayer.addModuleSet(singletonSet(std::move(M)),
+                                                         make_unique<TrackingMemoryManager>(Sections),
+                                                         std::move(Resolver));
+                }
 
-                ModuleHandles.push_back(H);
+                addRecord(H, std::move(Symbols), std::move(Sections));
                 return H;
             }
 
+            // Adds an object compiled outside of the JIT (by the CompileService),
+            // it's linked like the eager modules.
+            ModuleHandleT addObject(std::shared_ptr<ObjectT> Obj) {
+                std::vector<std::string> Symbols = definedSymbols(*Obj->getBinary());
+                auto Sections = std::make_shared<SectionRangesT>();
+                ModuleHandleT H;
+                H.Lazy = false;
+                H.EagerH = ObjectLayer.addObjectSet(singletonSet(std::move(Obj)),
+                                                    make_unique<TrackingMemoryManager>(Sections),
+                                                    createResolver());
+                addRecord(H, std::move(Symbols), std::move(Sections));
+                return H;
+            }
+
+            // Frees the code and data of the module. Nothing may refer to them anymore.
             void removeModule(ModuleHandleT H) {
-                ModuleHandles.erase(
-                        std::find(ModuleHandles.begin(), ModuleHandles.end(), H));
-                CompileLayer.removeModuleSet(H);
+                auto It = findRecord(H);
+                for (auto &Name : It->Symbols) {
+                    auto &Defs = SymbolIndex[Name];
+                    Defs.erase(std::find(Defs.begin(), Defs.end(), H));
+                    if (Defs.empty())
+                        SymbolIndex.erase(Name);
+                }
+                ModuleHandles.erase(It);
+                if (H.Lazy)
+                    CODLayer->removeModuleSet(H.LazyH);
+                else
+                    CompileLayer.removeModuleSet(H.EagerH);
+            }
+
+            // Address ranges of the module's sections (once its symbols were looked up),
+            // null if unknown (lazy modules)
+            std::shared_ptr<const SectionRangesT> getSections(ModuleHandleT H) {
+                return findRecord(H)->Sections;
             }
 
             JITSymbol findSymbol(const std::string Name) {
                 return findMangledSymbol(mangle(Name));
             }
 
+            // Lets the runtime provide its own objects for some
+            // of the external symbols (0 means not handled).
+            void setSymbolHook(std::function<uint64_t(const std::string &)> Hook) {
+                SymbolHook = std::move(Hook);
+            }
+
+            // Run on each function of a lazy module before its compilation
+            // (the module passed in contains just the function).
+            void setPartitionOptimizer(std::function<void(Module &)> Opt) {
+                PartitionOptimizer = std::move(Opt);
+            }
+
+            static TargetOptions getTargetOptions() {
+                TargetOptions Opts;
+                // Compiled Scheme code relies on proper tail calls (fastcc)
+                Opts.GuaranteedTailCallOpt = true;
+                return Opts;
+            }
+
         private:
+            struct ModuleRecord {
+                ModuleHandleT Handle;
+                // Mangled names of the exported definitions
+                std::vector<std::string> Symbols;
+                std::shared_ptr<SectionRangesT> Sections;
+            };
+
+            // Called by a stub whose function could not be compiled
+            static void lazyCompileError() {
+                std::cerr << "ScmJIT: lazy compilation failed." << std::endl;
+                std::abort();
+            }
+
+            std::vector<ModuleRecord>::iterator findRecord(const ModuleHandleT &H) {
+                // Usually one of the recent modules
+                auto It = std::find_if(ModuleHandles.rbegin(), ModuleHandles.rend(),
+                                       [&](const ModuleRecord &R) { return R.Handle == H; });
+                return std::prev(It.base());
+            }
+
+            std::unique_ptr<RuntimeDyld::SymbolResolver> createResolver() {
+                // We need a memory manager to allocate memory and resolve symbols for this
+                // new module. Create one that resolves symbols by looking back into the
+                // JIT.
+                return createLambdaResolver(
+                        [this](const std::string &Name) {
+                            if (SymbolHook) {
+                                if (uint64_t Addr = SymbolHook(Name))
+                                    return RuntimeDyld::SymbolInfo(Addr, JITSymbolFlags::Exported);
+                            }
+                            if (auto Sym = findMangledSymbol(Name))
+                                return RuntimeDyld::SymbolInfo(Sym.getAddress(), Sym.getFlags());
+                            return RuntimeDyld::SymbolInfo(nullptr);
+                        },
+                        [](const std::string &S) { return nullptr; });
+            }
+
+            void addRecord(const ModuleHandleT &H, std::vector<std::string> Symbols,
+                           std::shared_ptr<SectionRangesT> Sections) {
+                // The newest definition of a symbol is on the top of its stack
+                for (auto &Name : Symbols)
+                    SymbolIndex[Name].push_back(H);
+                ModuleHandles.push_back(ModuleRecord{H, std::move(Symbols), std::move(Sections)});
+            }
 
             std::string mangle(const std::string &Name) {
                 std::string MangledName;
@@ -86,6 +261,35 @@ namespace llvm {
                 return MangledName;
             }
 
+            std::vector<std::string> definedSymbols(Module &M) {
+                std::vector<std::string> Symbols;
+                auto Add = [&](GlobalValue &GV) {
+                    if (!GV.isDeclaration() && !GV.hasLocalLinkage()
+                        && !GV.hasAvailableExternallyLinkage())
+                        Symbols.push_back(mangle(GV.getName().str()));
+                };
+                for (auto &F : M)
+                    Add(F);
+                for (auto &G : M.globals())
+                    Add(G);
+                for (auto &A : M.aliases())
+                    Add(A);
+                return Symbols;
+            }
+
+            std::vector<std::string> definedSymbols(const object::ObjectFile &Obj) {
+                // Already mangled
+                std::vector<std::string> Symbols;
+                for (auto &Sym : Obj.symbols()) {
+                    uint32_t Flags = Sym.getFlags();
+                    if ((Flags & object::SymbolRef::SF_Undefined) || !(Flags & object::SymbolRef::SF_Global))
+                        continue;
+                    if (auto Name = Sym.getName())
+                        Symbols.push_back(Name->str());
+                }
+                return Symbols;
+            }
+
             template <typename T> static std::vector<T> singletonSet(T t) {
                 std::vector<T> Vec;
                 Vec.push_back(std::move(t));
@@ -93,12 +297,19 @@ namespace llvm {
             }
 
             JITSymbol findMangledSymbol(const std::string &Name) {
-                // Search modules in reverse order: from last added to first added.
+                // Only the module with the newest definition is searched.
                 // This is the opposite of the usual search order for dlsym, but makes more
                 // sense in a REPL where we want to bind to the newest available definition.
-                for (auto H : make_range(ModuleHandles.rbegin(), ModuleHandles.rend()))
-                    if (auto Sym = CompileLayer.findSymbolIn(H, Name, true))
+                auto It = SymbolIndex.find(Name);
+                if (It != SymbolIndex.end()) {
+                    const ModuleHandleT &H = It->second.back();
+                    if (H.Lazy) {
+                        if (auto Sym = CODLayer->findSymbolIn(H.LazyH, Name, true))
+                            return Sym;
+                    }
+                    else if (auto Sym = CompileLayer.findSymbolIn(H.EagerH, Name, true))
                         return Sym;
+                }
 
                 // If we can't find the symbol in the JIT, try looking in the host process.
                 if (auto SymAddr = RTDyldMemoryManager::getSymbolAddressInProcess(Name))
@@ -111,7 +322,16 @@ namespace llvm {
             const DataLayout DL;
             ObjLayerT ObjectLayer;
             CompileLayerT CompileLayer;
-            std::vector<ModuleHandleT> ModuleHandles;
+            OptimizeLayerT OptimizeLayer;
+            // Null unless in the lazy mode
+            std::unique_ptr<LocalJITCompileCallbackManager<OrcX86_64>> CompileCallbackMgr;
+            std::unique_ptr<CODLayerT> CODLayer;
+            bool Lazy;
+            std::vector<ModuleRecord> ModuleHandles;
+            // Mangled name -> modules defining it, in the order of addition
+            std::unordered_map<std::string, std::vector<ModuleHandleT>> SymbolIndex;
+            std::function<uint64_t(const std::string &)> SymbolHook;
+            std::function<void(Module &)> PartitionOptimizer;
         };
 
     } // End namespace orc.
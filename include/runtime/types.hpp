@@ -3,6 +3,8 @@
 
 // LLscheme runtime type tags and their string representation
 
+#include <cstdint>
+
 #define EOF_ORIG EOF
 #undef EOF
 
@@ -21,4 +23,17 @@ static const char * TagName[] = {
 
 #define EOF EOF_ORIG
 
+// Small integers (fixnums) are not allocated on the heap.
+// They are stored directly in the object pointer as (value << 1) | 1.
+// Every heap object is at least 4-byte aligned, so a set low bit
+// can never be mistaken for a real pointer.
+#define FIXNUM_TAG 1
+#define FIXNUM_SHIFT 1
+#define FIXNUM_MAX (INT64_MAX >> FIXNUM_SHIFT)
+#define FIXNUM_MIN (INT64_MIN >> FIXNUM_SHIFT)
+
+// Symbol objects emitted by the compiler are global variables
+// named SCM_SYM_PREFIX + symbol name
+#define SCM_SYM_PREFIX "__scm_sym."
+
 #endif //LLSCHEME_TYPES_HPP
\ No newline at end of file
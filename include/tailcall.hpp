@@ -0,0 +1,14 @@
+#ifndef LLSCHEME_TAILCALL_HPP
+#define LLSCHEME_TAILCALL_HPP
+
+#include "ast.hpp"
+
+namespace llscm {
+    // Marks calls in tail position of the function body
+    // (ScmCall::tail_call). Direct calls of the function itself
+    // are marked as self tail calls and the function gets
+    // has_self_tail_call set, so that codegen can turn them into a loop.
+    void markTailCalls(ScmFunc * func);
+}
+
+#endif //LLSCHEME_TAILCALL_HPP
@@ -752,37 +752,72 @@ namespace llscm {
 		return os;
 	}
 
-	ScmConsFunc::ScmConsFunc() : Visitable(2, RuntimeSymbol::cons) {}
+	ScmConsFunc::ScmConsFunc() : Visitable(2, RuntimeSymbol::cons) { is_native = true; }
 
-	ScmCarFunc::ScmCarFunc() : Visitable(1, RuntimeSymbol::car) {}
+	ScmCarFunc::ScmCarFunc() : Visitable(1, RuntimeSymbol::car) { is_native = true; }
 
-	ScmCdrFunc::ScmCdrFunc() : Visitable(1, RuntimeSymbol::cdr) {}
+	ScmCdrFunc::ScmCdrFunc() : Visitable(1, RuntimeSymbol::cdr) { is_native = true; }
 
-	ScmNullFunc::ScmNullFunc() : Visitable(1, RuntimeSymbol::is_null) {}
+	ScmNullFunc::ScmNullFunc() : Visitable(1, RuntimeSymbol::is_null) {
+		is_native = true;
+		facts = FN_RET_BOOL;
+	}
 
-	ScmPlusFunc::ScmPlusFunc() : Visitable(ArgsAnyCount, RuntimeSymbol::plus) {}
+	ScmPlusFunc::ScmPlusFunc() : Visitable(ArgsAnyCount, RuntimeSymbol::plus) { is_native = true; }
 
-	ScmMinusFunc::ScmMinusFunc() : Visitable(ArgsAnyCount, RuntimeSymbol::minus) {}
+	ScmMinusFunc::ScmMinusFunc() : Visitable(ArgsAnyCount, RuntimeSymbol::minus) { is_native = true; }
 
-	ScmTimesFunc::ScmTimesFunc() : Visitable(ArgsAnyCount, RuntimeSymbol::times) {}
+	ScmTimesFunc::ScmTimesFunc() : Visitable(ArgsAnyCount, RuntimeSymbol::times) { is_native = true; }
 
-	ScmDivFunc::ScmDivFunc() : Visitable(ArgsAnyCount, RuntimeSymbol::div) {}
+	ScmDivFunc::ScmDivFunc() : Visitable(ArgsAnyCount, RuntimeSymbol::div) { is_native = true; }
 
-	ScmGtFunc::ScmGtFunc() : Visitable(2, RuntimeSymbol::gt) {}
+	ScmGtFunc::ScmGtFunc() : Visitable(2, RuntimeSymbol::gt) {
+		is_native = true;
+		facts = FN_RET_BOOL;
+	}
 
-	ScmDisplayFunc::ScmDisplayFunc() : Visitable(1, RuntimeSymbol::display) {}
+	ScmLtFunc::ScmLtFunc() : Visitable(2, RuntimeSymbol::lt) {
+		is_native = true;
+		facts = FN_RET_BOOL;
+	}
 
-	ScmNumEqFunc::ScmNumEqFunc() : Visitable(2, RuntimeSymbol::num_eq) {}
+	ScmLeFunc::ScmLeFunc() : Visitable(2, RuntimeSymbol::le) {
+		is_native = true;
+		facts = FN_RET_BOOL;
+	}
 
-	ScmCmdArgsFunc::ScmCmdArgsFunc() : Visitable(0, RuntimeSymbol::cmd_args) {}
+	ScmGeFunc::ScmGeFunc() : Visitable(2, RuntimeSymbol::ge) {
+		is_native = true;
+		facts = FN_RET_BOOL;
+	}
 
-	ScmVecLenFunc::ScmVecLenFunc() : Visitable(1, RuntimeSymbol::vec_len) {}
+	ScmEqFunc::ScmEqFunc() : Visitable(2, RuntimeSymbol::eq) {
+		is_native = true;
+		facts = FN_RET_BOOL;
+	}
 
-	ScmVecRefFunc::ScmVecRefFunc() : Visitable(2, RuntimeSymbol::vec_ref) {}
+	ScmDisplayFunc::ScmDisplayFunc() : Visitable(1, RuntimeSymbol::display) { is_native = true; }
 
-	ScmApplyFunc::ScmApplyFunc() : Visitable(2, RuntimeSymbol::apply) {}
+	ScmNumEqFunc::ScmNumEqFunc() : Visitable(2, RuntimeSymbol::num_eq) {
+		is_native = true;
+		facts = FN_RET_BOOL;
+	}
 
-	ScmLengthFunc::ScmLengthFunc() : Visitable(1, RuntimeSymbol::length){}
+	ScmCmdArgsFunc::ScmCmdArgsFunc() : Visitable(0, RuntimeSymbol::cmd_args) { is_native = true; }
+
+	ScmVecLenFunc::ScmVecLenFunc() : Visitable(1, RuntimeSymbol::vec_len) {
+		is_native = true;
+		facts = FN_RET_FIXNUM;
+	}
+
+	ScmVecRefFunc::ScmVecRefFunc() : Visitable(2, RuntimeSymbol::vec_ref) { is_native = true; }
+
+	ScmApplyFunc::ScmApplyFunc() : Visitable(2, RuntimeSymbol::apply) { is_native = true; }
+
+	ScmLengthFunc::ScmLengthFunc() : Visitable(1, RuntimeSymbol::length) {
+		is_native = true;
+		facts = FN_RET_FIXNUM;
+	}
 
 	ostream & ScmRequire::print(ostream & os, int tabs) const {
 		printTabs(os, tabs);
@@ -799,9 +834,9 @@ namespace llscm {
 	}
 
 	P_ScmObj ScmRequire::CT_Eval(P_ScmEnv env) {
-		LibReader librd;
-		Metadata input_meta;
+		shared_ptr<LibExports> lib = make_shared<LibExports>();
 		void * metainfo_blob;
+		size_t metainfo_size = 0;
 		string lib_name_str = DPC<ScmStr>(lib_name).get()->val;
 
 		if (!StringRef(lib_name_str).endswith(".so")) {
@@ -832,28 +867,25 @@ namespace llscm {
 				return shared_from_this();
 			}
 
-			if (!librd.load(res.first)) {
+			if (!lib->reader.load(res.first)) {
 				env->error("Could not load the requested library.");
 				return shared_from_this();
 			}
 
-			metainfo_blob = librd.getAddressOfSymbol("__llscheme_metainfo__");
+			metainfo_blob = lib->reader.getAddressOfSymbol("__llscheme_metainfo__", &metainfo_size);
 			if (!metainfo_blob) {
 				env->error("The requested library does not contain any metainfo.");
 				return shared_from_this();
 			}
 		}
 
-		if (!input_meta.loadFromBlob(metainfo_blob)) {
+		if (!lib->meta.loadFromBlob(metainfo_blob, metainfo_size)) {
 			env->error("Invalid metadata in the runtime library.");
 			return shared_from_this();
 		}
 
-		input_meta.foreachRecord([env](FunctionInfo *rec) {
-			D(cerr << "Found function \"" << rec->name << "\" with " << rec->argc << " args." << endl);
-			// Add the function into environment
-			env->set(rec->name, make_shared<ScmFunc>(rec->argc, rec->name));
-		});
+		// The exports are bound when the program refers to them
+		env->addLibrary(lib);
 
 		return shared_from_this();
 	}
@@ -0,0 +1,196 @@
+#include <unordered_map>
+#include <vector>
+#include <llvm/ADT/SmallPtrSet.h>
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/Bitcode/ReaderWriter.h>
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/GlobalVariable.h>
+#include <llvm/Linker/Linker.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include "../include/bitcode.hpp"
+#include "../include/debug.hpp"
+
+namespace llscm {
+    using namespace std;
+    using namespace llvm;
+
+    const char * EmbeddedBitcodeSym = "__llscheme_bitcode__";
+
+    void embedBitcode(Module & mod) {
+        SmallVector<char, 0> buf;
+        raw_svector_ostream os(buf);
+        WriteBitcodeToFile(&mod, os);
+
+        Constant * data = ConstantDataArray::get(
+                mod.getContext(),
+                ArrayRef<uint8_t>((const uint8_t*)buf.data(), buf.size())
+        );
+        GlobalVariable * gv = new GlobalVariable(
+                mod, data->getType(), true,
+                GlobalValue::ExternalLinkage,
+                data, EmbeddedBitcodeSym
+        );
+        // The bitcode reader wants 32-bit words
+        gv->setAlignment(4);
+    }
+
+    static void collectRefs(User * user, SmallPtrSetImpl<GlobalValue*> & refs) {
+        for (Value * op: user->operands()) {
+            if (auto gv = dyn_cast<GlobalValue>(op)) {
+                refs.insert(gv);
+            }
+            else if (auto c = dyn_cast<Constant>(op)) {
+                collectRefs(c, refs);
+            }
+        }
+    }
+
+    static bool canCopy(GlobalValue * gv, unordered_map<GlobalValue*, bool> & cache);
+
+    static bool canReference(const SmallPtrSetImpl<GlobalValue*> & refs,
+                             unordered_map<GlobalValue*, bool> & cache) {
+        for (GlobalValue * gv: refs) {
+            // Exported symbols are resolved to the library at link time
+            if (gv->hasLocalLinkage() && !canCopy(gv, cache)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static bool canCopy(GlobalValue * gv, unordered_map<GlobalValue*, bool> & cache) {
+        // Copied into the user module together with the imported code.
+        // That is fine for constants and code, but not for the library state.
+        auto it = cache.find(gv);
+        if (it != cache.end()) {
+            return it->second;
+        }
+        // Recursive references are not followed
+        cache[gv] = false;
+
+        SmallPtrSet<GlobalValue*, 16> refs;
+        if (auto var = dyn_cast<GlobalVariable>(gv)) {
+            if (!var->isConstant()) {
+                return false;
+            }
+            collectRefs(var, refs);
+        }
+        else if (auto fn = dyn_cast<Function>(gv)) {
+            for (BasicBlock & bb: *fn) {
+                for (Instruction & inst: bb) {
+                    collectRefs(&inst, refs);
+                }
+            }
+        }
+        else {
+            return false;
+        }
+
+        bool res = canReference(refs, cache);
+        cache[gv] = res;
+        return res;
+    }
+
+    static unique_ptr<Module> parseLibrary(LLVMContext & ctx, StringRef bitcode) {
+        unique_ptr<MemoryBuffer> buf = MemoryBuffer::getMemBuffer(bitcode, "", false);
+        ErrorOr<unique_ptr<Module>> lib = parseBitcodeFile(buf->getMemBufferRef(), ctx);
+        if (!lib) {
+            return nullptr;
+        }
+        return move(*lib);
+    }
+
+    bool importBitcode(Module & mod, StringRef bitcode) {
+        unique_ptr<Module> lib = parseLibrary(mod.getContext(), bitcode);
+        if (!lib) {
+            return false;
+        }
+        Module & src = *lib;
+
+        // Constructors and metadata of the library stay in the library
+        vector<GlobalVariable*> appending;
+        for (GlobalVariable & gv: src.globals()) {
+            if (gv.hasAppendingLinkage()) {
+                appending.push_back(&gv);
+            }
+        }
+        for (GlobalVariable * gv: appending) {
+            gv->eraseFromParent();
+        }
+
+        unordered_map<GlobalValue*, bool> cache;
+        for (Function & fn: src) {
+            if (fn.isDeclaration() || fn.hasLocalLinkage()) {
+                continue;
+            }
+
+            Function * decl = mod.getFunction(fn.getName());
+            bool used = decl && decl->isDeclaration();
+            SmallPtrSet<GlobalValue*, 16> refs;
+            if (used) {
+                for (BasicBlock & bb: fn) {
+                    for (Instruction & inst: bb) {
+                        collectRefs(&inst, refs);
+                    }
+                }
+            }
+
+            if (used && canReference(refs, cache)) {
+                D(cerr << "importing " << fn.getName().str() << endl);
+                fn.setLinkage(GlobalValue::AvailableExternallyLinkage);
+            }
+            else {
+                fn.deleteBody();
+            }
+        }
+
+        // Exported variables are accessed in the library
+        for (GlobalVariable & gv: src.globals()) {
+            if (gv.hasExternalLinkage() && gv.hasInitializer()) {
+                gv.setInitializer(nullptr);
+            }
+        }
+
+        // Drop the private library code and data nobody refers to anymore
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            vector<GlobalValue*> dead;
+            for (GlobalVariable & gv: src.globals()) {
+                gv.removeDeadConstantUsers();
+                if (gv.hasLocalLinkage() && gv.use_empty()) {
+                    dead.push_back(&gv);
+                }
+            }
+            for (Function & fn: src) {
+                fn.removeDeadConstantUsers();
+                if (fn.hasLocalLinkage() && fn.use_empty()) {
+                    dead.push_back(&fn);
+                }
+            }
+            for (GlobalValue * gv: dead) {
+                gv->eraseFromParent();
+                changed = true;
+            }
+        }
+
+        return !Linker::linkModules(mod, move(lib));
+    }
+
+    bool linkLibrary(Module & mod, unique_ptr<Module> lib) {
+        // Only the compiler reads the metadata (from the shared library)
+        if (GlobalVariable * meta = lib->getNamedGlobal("__llscheme_metainfo__")) {
+            meta->eraseFromParent();
+        }
+        return !Linker::linkModules(mod, move(lib));
+    }
+
+    bool linkBitcode(Module & mod, StringRef bitcode) {
+        unique_ptr<Module> lib = parseLibrary(mod.getContext(), bitcode);
+        if (!lib) {
+            return false;
+        }
+        return linkLibrary(mod, move(lib));
+    }
+}
@@ -0,0 +1,124 @@
+#include "../include/closure.hpp"
+#include "../include/escape.hpp"
+#include "../include/debug.hpp"
+
+namespace llscm {
+    using namespace std;
+
+    static void collectDefines(P_ScmObj & body_list, vector<ScmDefineVarSyntax*> & defs) {
+        // Nested defines may appear in function and let bodies
+        if (!body_list || body_list->t != T_CONS) {
+            return;
+        }
+        DPC<ScmCons>(body_list)->each([&defs](P_ScmObj & e) {
+            if (auto def = dynamic_cast<ScmDefineVarSyntax*>(e.get())) {
+                defs.push_back(def);
+            }
+            else if (auto let_expr = dynamic_cast<ScmLetSyntax*>(e.get())) {
+                collectDefines(let_expr->body_list, defs);
+            }
+        });
+    }
+
+    static bool addVar(unordered_map<ScmObj*, int32_t> & idx, vector<ScmObj*> & vars, ScmObj * var) {
+        if (idx.count(var)) {
+            return false;
+        }
+        idx[var] = (int32_t)vars.size();
+        vars.push_back(var);
+        return true;
+    }
+
+    void FlatClosures::analyze(ScmObj * prog) {
+        vector<RefUse> top_uses;
+        vector<ScmFunc*> worklist;
+        // Functions in the order of their discovery (keeps the record layout stable)
+        vector<ScmFunc*> funcs;
+        unordered_map<ScmFunc*, vector<RefUse>> body_uses;
+
+        collectUses(prog, top_uses, worklist);
+        while (!worklist.empty()) {
+            ScmFunc * func = worklist.back();
+            worklist.pop_back();
+            if (!func->body_list || body_uses.count(func)) {
+                continue;
+            }
+
+            funcs.push_back(func);
+            vector<RefUse> & uses = body_uses[func];
+            DPC<ScmCons>(func->body_list)->each([&uses, &worklist](P_ScmObj & e) {
+                collectUses(e.get(), uses, worklist);
+            });
+        }
+
+        // Variables referenced directly and the nested functions
+        // whose records are filled in by the function.
+        unordered_map<ScmFunc*, vector<ScmFunc*>> nested;
+        for (ScmFunc * func: funcs) {
+            auto & idx = var_idx[func];
+            auto & vars = free_vars[func];
+
+            for (auto & u: body_uses[func]) {
+                ScmObj * robj = u.ref->refObj().get();
+                if (!robj) {
+                    continue;
+                }
+                if (robj->location == T_HEAP_LOC) {
+                    if (robj->defined_in_func != func) {
+                        addVar(idx, vars, robj);
+                    }
+                }
+                else if (auto fn = dynamic_cast<ScmFunc*>(robj)) {
+                    if (fn->has_closure && fn != func) {
+                        nested[func].push_back(fn);
+                    }
+                }
+            }
+
+            vector<ScmDefineVarSyntax*> defs;
+            collectDefines(func->body_list, defs);
+            for (auto def: defs) {
+                ScmObj * val = def->val.get();
+                if (val->location == T_HEAP_LOC && val->t != T_FUNC) {
+                    boxed.insert(val);
+                    boxed_locals.insert(val->defined_in_func);
+                }
+            }
+        }
+
+        // Function has to provide all the variables its nested functions
+        // need, except its own locals.
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (ScmFunc * func: funcs) {
+                auto & idx = var_idx[func];
+                auto & vars = free_vars[func];
+
+                for (ScmFunc * fn: nested[func]) {
+                    vector<ScmObj*> fn_vars = free_vars[fn];
+                    for (ScmObj * var: fn_vars) {
+                        if (var->defined_in_func != func && addVar(idx, vars, var)) {
+                            changed = true;
+                        }
+                    }
+                }
+            }
+        }
+
+        for (ScmFunc * func: funcs) {
+            if (!free_vars[func].empty()) {
+                D(cerr << func->name << ": " << free_vars[func].size() << " closure vars" << endl);
+                // The record is passed as the context pointer
+                func->has_closure = true;
+            }
+        }
+    }
+
+    int32_t FlatClosures::index(ScmFunc * func, ScmObj * var) {
+        auto & idx = var_idx[func];
+        auto it = idx.find(var);
+        assert(it != idx.end());
+        return it->second;
+    }
+}
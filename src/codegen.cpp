@@ -3,6 +3,10 @@
 #include <llvm/Analysis/Passes.h>
 #include <llvm/Transforms/Scalar.h>
 #include <llvm/Transforms/Scalar/SimplifyCFG.h>
+#include <llvm/IR/MDBuilder.h>
+#include <llvm/Analysis/TargetTransformInfo.h>
+#include <llvm/Transforms/IPO.h>
+#include <llvm/Transforms/IPO/PassManagerBuilder.h>
 #include "../include/codegen.hpp"
 #include "../include/debug.hpp"
 
@@ -15,7 +19,14 @@ namespace llscm {
     const char * RuntimeSymbol::minus = "scm_minus";
     const char * RuntimeSymbol::times = "scm_times";
     const char * RuntimeSymbol::div = "scm_div";
+    const char * RuntimeSymbol::plus2 = "scm_plus2";
+    const char * RuntimeSymbol::minus2 = "scm_minus2";
+    const char * RuntimeSymbol::times2 = "scm_times2";
+    const char * RuntimeSymbol::div2 = "scm_div2";
     const char * RuntimeSymbol::gt = "scm_gt";
+    const char * RuntimeSymbol::lt = "scm_lt";
+    const char * RuntimeSymbol::le = "scm_le";
+    const char * RuntimeSymbol::ge = "scm_ge";
     const char * RuntimeSymbol::display = "scm_display";
     const char * RuntimeSymbol::num_eq = "scm_num_eq";
     const char * RuntimeSymbol::cmd_args = "scm_cmd_args";
@@ -26,11 +37,15 @@ namespace llscm {
     const char * RuntimeSymbol::exit_code = "exit_code";
     const char * RuntimeSymbol::alloc_heap_storage = "alloc_heap_storage";
     const char * RuntimeSymbol::alloc_func = "alloc_func";
+    const char * RuntimeSymbol::alloc_cons = "alloc_cons";
+    const char * RuntimeSymbol::intern_static_sym = "intern_static_sym";
+    const char * RuntimeSymbol::eq = "scm_eq";
     const char * RuntimeSymbol::error_not_a_func = "error_not_a_function";
     const char * RuntimeSymbol::error_wrong_arg_num = "error_wrong_arg_num";
     const char * RuntimeSymbol::apply = "scm_apply";
     const char * RuntimeSymbol::length = "scm_length";
     const char * RuntimeSymbol::eval = "scm_eval";
+    const char * RuntimeSymbol::eval_batch = "scm_eval_batch";
     const char * RuntimeSymbol::make_base_nspace = "scm_make_base_nspace";
     const char * RuntimeSymbol::current_nspace = "scm_current_nspace";
     const char * RuntimeSymbol::read = "scm_read";
@@ -47,6 +62,10 @@ namespace llscm {
     const char * RuntimeSymbol::equal = "scm_equal";
     const char * RuntimeSymbol::exit = "scm_exit";
     const char * RuntimeSymbol::random = "scm_random";
+    const char * RuntimeSymbol::collect_garbage = "scm_collect_garbage";
+    const char * RuntimeSymbol::null_obj = "_ZN5llscm7runtime8Constant8scm_nullE";
+    const char * RuntimeSymbol::true_obj = "_ZN5llscm7runtime8Constant8scm_trueE";
+    const char * RuntimeSymbol::false_obj = "_ZN5llscm7runtime8Constant9scm_falseE";
 
     ScmCodeGen::ScmCodeGen(LLVMContext &ctxt, ScmProg * tree):
             context(ctxt), builder(ctxt), ast(tree) {
@@ -55,6 +74,8 @@ namespace llscm {
         initExternFuncs();
         initPassManager();
         entry_func = nullptr;
+        flat_closures = false;
+        optlevel = 1;
 
         // Not adding main function by default
         addEntryFuncProlog = &ScmCodeGen::addLibInitFuncProlog;
@@ -227,6 +248,30 @@ namespace llscm {
                 RuntimeSymbol::alloc_func, module.get()
         );
 
+        func_type = FunctionType::get(
+                t.scm_type_ptr,
+                { t.scm_type_ptr, t.scm_type_ptr },
+                false
+        );
+
+        fn.alloc_cons = Function::Create(
+                func_type,
+                GlobalValue::ExternalLinkage,
+                RuntimeSymbol::alloc_cons, module.get()
+        );
+
+        func_type = FunctionType::get(
+                t.scm_type_ptr,
+                { t.scm_type_ptr },
+                false
+        );
+
+        fn.intern_static_sym = Function::Create(
+                func_type,
+                GlobalValue::ExternalLinkage,
+                RuntimeSymbol::intern_static_sym, module.get()
+        );
+
         func_type = FunctionType::get(
                 PointerType::get(t.scm_type_ptr, 0),
                 { t.ti32 },
@@ -264,6 +309,45 @@ namespace llscm {
         );
     }
 
+    void ScmCodeGen::optimizeModule(TargetMachine * tm) {
+        optimizeModule(*module, optlevel, tm);
+    }
+
+    void ScmCodeGen::optimizeModule(Module & mod, unsigned optlevel, TargetMachine * tm) {
+        if (optlevel == 0) {
+            return;
+        }
+
+        PassManagerBuilder pmb;
+        pmb.OptLevel = min(optlevel, 3u);
+        pmb.SizeLevel = 0;
+        if (optlevel > 1) {
+            pmb.Inliner = createFunctionInliningPass(pmb.OptLevel, 0);
+        }
+        else {
+            pmb.Inliner = createAlwaysInlinerPass();
+        }
+        pmb.LoopVectorize = optlevel > 2;
+        pmb.SLPVectorize = optlevel > 2;
+
+        legacy::FunctionPassManager fpm(&mod);
+        legacy::PassManager mpm;
+        if (tm) {
+            fpm.add(createTargetTransformInfoWrapperPass(tm->getTargetIRAnalysis()));
+            mpm.add(createTargetTransformInfoWrapperPass(tm->getTargetIRAnalysis()));
+        }
+        pmb.populateFunctionPassManager(fpm);
+        pmb.populateModulePassManager(mpm);
+
+        fpm.doInitialization();
+        for (Function & f: mod) {
+            fpm.run(f);
+        }
+        fpm.doFinalization();
+
+        mpm.run(mod);
+    }
+
     void ScmCodeGen::initPassManager() {
         passman = make_unique<legacy::FunctionPassManager>(module.get());
 
@@ -480,8 +564,358 @@ namespace llscm {
         );
     }
 
+    Value * ScmCodeGen::genRuntimeConstant(const char * name) {
+        // '(), #t and #f are the same objects in all modules
+        // and in the runtime, so eq? can compare them by address
+        GlobalVariable * gv = module->getGlobalVariable(name);
+        if (!gv) {
+            gv = new GlobalVariable(
+                    *module, t.scm_type, true,
+                    GlobalValue::ExternalLinkage,
+                    nullptr, name
+            );
+        }
+        return gv;
+    }
+
+    Constant * ScmCodeGen::genFixnumConstant(int64_t val) {
+        uint64_t word = ((uint64_t)val << FIXNUM_SHIFT) | FIXNUM_TAG;
+        return ConstantExpr::getIntToPtr(builder.getInt64(word), t.scm_type_ptr);
+    }
+
+    Value * ScmCodeGen::genIsFixnum(Value * obj) {
+        Value * word = builder.CreatePtrToInt(obj, builder.getInt64Ty());
+        Value * tag_bit = builder.CreateAnd(word, FIXNUM_TAG);
+        return builder.CreateICmpNE(tag_bit, builder.getInt64(0));
+    }
+
+    Value * ScmCodeGen::genKnownTag(Value * obj) {
+        // The runtime's constants are only declared, the optimizer can't load their tags
+        obj = obj->stripPointerCasts();
+        if (auto sel = dyn_cast<SelectInst>(obj)) {
+            Value * tv = genKnownTag(sel->getTrueValue());
+            Value * fv = tv ? genKnownTag(sel->getFalseValue()) : nullptr;
+            return fv ? builder.CreateSelect(sel->getCondition(), tv, fv) : nullptr;
+        }
+        auto gv = dyn_cast<GlobalVariable>(obj);
+        if (!gv || !gv->isDeclaration()) {
+            return nullptr;
+        }
+        StringRef name = gv->getName();
+        if (name == RuntimeSymbol::null_obj) {
+            return builder.getInt32(S_NIL);
+        }
+        if (name == RuntimeSymbol::true_obj) {
+            return builder.getInt32(S_TRUE);
+        }
+        if (name == RuntimeSymbol::false_obj) {
+            return builder.getInt32(S_FALSE);
+        }
+        return nullptr;
+    }
+
+    Value * ScmCodeGen::genGetTag(Value * obj) {
+        if (Value * tag = genKnownTag(obj)) {
+            return tag;
+        }
+        // Fixnums have no header we could load the tag from.
+        // The type must be derived from the pointer itself first.
+        bool is_bool = bool_vals.count(obj);
+        obj = builder.CreateBitCast(obj, t.scm_type_ptr);
+        if (is_bool) {
+            vector<Value*> indices(2, builder.getInt32(0));
+            return builder.CreateLoad(t.ti32, builder.CreateGEP(obj, indices));
+        }
+        return genIfElse(
+                [this, obj] () {
+                    return genIsFixnum(obj);
+                },
+                [this] () {
+                    return builder.getInt32(S_INT);
+                },
+                [this, obj] () {
+                    vector<Value*> indices(2, builder.getInt32(0));
+                    return builder.CreateLoad(t.ti32, builder.CreateGEP(obj, indices));
+                }
+        );
+    }
+
+    MDNode * ScmCodeGen::genBranchWeights(uint32_t likely, uint32_t unlikely) {
+        return MDBuilder(context).createBranchWeights(likely, unlikely);
+    }
+
+    Value * ScmCodeGen::genTagEquals(Value * obj, Tag tag) {
+        return builder.CreateICmpEQ(genGetTag(obj), builder.getInt32(tag));
+    }
+
+    Value * ScmCodeGen::genBoolean(Value * cond) {
+        return builder.CreateSelect(cond, genRuntimeConstant(RuntimeSymbol::true_obj),
+                                    genRuntimeConstant(RuntimeSymbol::false_obj));
+    }
+
+    Value * ScmCodeGen::genNativeCall(ScmFunc * fn_obj, vector<Value*> args) {
+        Function * func = dyn_cast<Function>(codegen(fn_obj));
+        assert(func);
+
+        if (fn_obj->argc_expected == ArgsAnyCount) {
+            args.push_back(ConstantPointerNull::get(
+                    PointerType::get(t.scm_type_ptr, 0)
+            ));
+        }
+
+        return builder.CreateCall(func, args, fn_obj->name);
+    }
+
+    Value * ScmCodeGen::genBinaryCall(const char * name, const vector<Value*> & args) {
+        // Fixed arity entry points of the variadic arithmetic functions
+        // (no need to walk the va_list when we know there are two arguments)
+        Function * func = module->getFunction(name);
+        if (!func) {
+            func = Function::Create(
+                    FunctionType::get(t.scm_type_ptr, { t.scm_type_ptr, t.scm_type_ptr }, false),
+                    GlobalValue::ExternalLinkage,
+                    name, module.get()
+            );
+        }
+        return builder.CreateCall(func, args);
+    }
+
+    Value * ScmCodeGen::genOverflowOp(Intrinsic::ID op, Value * a, Value * b, Value *& overflow) {
+        Function * intr = Intrinsic::getDeclaration(module.get(), op, { builder.getInt64Ty() });
+        Value * res = builder.CreateCall(intr, { a, b });
+        overflow = builder.CreateExtractValue(res, 1);
+        return builder.CreateExtractValue(res, 0);
+    }
+
+    Value * ScmCodeGen::genInlineConsField(ScmFunc * node, Value * obj, int32_t field) {
+        return genIfElse(
+                [this, obj] () {
+                    return genTagEquals(obj, S_CONS);
+                },
+                [this, obj, field] () {
+                    Value * cell = builder.CreateBitCast(obj, PointerType::get(t.scm_cons, 0));
+                    vector<Value*> indices = { builder.getInt32(0), builder.getInt32(field) };
+                    return builder.CreateLoad(t.scm_type_ptr, builder.CreateGEP(cell, indices));
+                },
+                [this, node, obj] () { // Not a pair, let the runtime report the error
+                    return genNativeCall(node, { obj });
+                }
+        );
+    }
+
+    Value * ScmCodeGen::genInlineCompare(ScmFunc * node, const vector<Value*> & args, CmpInst::Predicate pred) {
+        // Tagged fixnums keep their ordering, so we can compare the words directly
+        return genFixnumFastPath(
+                args,
+                [this, pred] (Value * a, Value * b, Value *&) {
+                    return genBoolean(builder.CreateICmp(pred, a, b));
+                },
+                [this, node, &args] () {
+                    return genNativeCall(node, args);
+                }
+        );
+    }
+
+    Value * ScmCodeGen::genInline(ScmConsFunc *, const vector<Value*> & args) {
+        return builder.CreateCall(fn.alloc_cons, args);
+    }
+
+    Value * ScmCodeGen::genInline(ScmCarFunc * node, const vector<Value*> & args) {
+        return genInlineConsField(node, args[0], 1);
+    }
+
+    Value * ScmCodeGen::genInline(ScmCdrFunc * node, const vector<Value*> & args) {
+        return genInlineConsField(node, args[0], 2);
+    }
+
+    Value * ScmCodeGen::genInline(ScmNullFunc *, const vector<Value*> & args) {
+        return genBoolean(genTagEquals(args[0], S_NIL));
+    }
+
+    Value * ScmCodeGen::genInline(ScmPlusFunc * node, const vector<Value*> & args) {
+        if (args.size() != 2) return nullptr;
+        // (2a + 1) + (2b + 1) - 1 = 2(a + b) + 1
+        return genFixnumFastPath(
+                args,
+                [this] (Value * a, Value * b, Value *& overflow) {
+                    Value * untagged_b = builder.CreateSub(b, builder.getInt64(FIXNUM_TAG));
+                    Value * res = genOverflowOp(Intrinsic::sadd_with_overflow, a, untagged_b, overflow);
+                    return builder.CreateIntToPtr(res, t.scm_type_ptr);
+                },
+                [this, &args] () {
+                    return genBinaryCall(RuntimeSymbol::plus2, args);
+                }
+        );
+    }
+
+    Value * ScmCodeGen::genInline(ScmMinusFunc * node, const vector<Value*> & args) {
+        if (args.size() != 2) return nullptr;
+        // (2a + 1) - (2b + 1 - 1) = 2(a - b) + 1
+        return genFixnumFastPath(
+                args,
+                [this] (Value * a, Value * b, Value *& overflow) {
+                    Value * untagged_b = builder.CreateSub(b, builder.getInt64(FIXNUM_TAG));
+                    Value * res = genOverflowOp(Intrinsic::ssub_with_overflow, a, untagged_b, overflow);
+                    return builder.CreateIntToPtr(res, t.scm_type_ptr);
+                },
+                [this, &args] () {
+                    return genBinaryCall(RuntimeSymbol::minus2, args);
+                }
+        );
+    }
+
+    Value * ScmCodeGen::genInline(ScmTimesFunc * node, const vector<Value*> & args) {
+        if (args.size() != 2) return nullptr;
+        // a * (2b + 1 - 1) + 1 = 2ab + 1
+        return genFixnumFastPath(
+                args,
+                [this] (Value * a, Value * b, Value *& overflow) {
+                    Value * val_a = builder.CreateAShr(a, FIXNUM_SHIFT);
+                    Value * untagged_b = builder.CreateSub(b, builder.getInt64(FIXNUM_TAG));
+                    Value * res = genOverflowOp(Intrinsic::smul_with_overflow, val_a, untagged_b, overflow);
+                    res = builder.CreateOr(res, builder.getInt64(FIXNUM_TAG));
+                    return builder.CreateIntToPtr(res, t.scm_type_ptr);
+                },
+                [this, &args] () {
+                    return genBinaryCall(RuntimeSymbol::times2, args);
+                }
+        );
+    }
+
+    Value * ScmCodeGen::genInline(ScmDivFunc *, const vector<Value*> & args) {
+        if (args.size() != 2) return nullptr;
+        // Division always yields a float, so there is no fast path
+        return genBinaryCall(RuntimeSymbol::div2, args);
+    }
+
+    Value * ScmCodeGen::genInline(ScmGtFunc * node, const vector<Value*> & args) {
+        return genInlineCompare(node, args, CmpInst::ICMP_SGT);
+    }
+
+    Value * ScmCodeGen::genInline(ScmLtFunc * node, const vector<Value*> & args) {
+        return genInlineCompare(node, args, CmpInst::ICMP_SLT);
+    }
+
+    Value * ScmCodeGen::genInline(ScmLeFunc * node, const vector<Value*> & args) {
+        return genInlineCompare(node, args, CmpInst::ICMP_SLE);
+    }
+
+    Value * ScmCodeGen::genInline(ScmGeFunc * node, const vector<Value*> & args) {
+        return genInlineCompare(node, args, CmpInst::ICMP_SGE);
+    }
+
+    Value * ScmCodeGen::genInline(ScmNumEqFunc * node, const vector<Value*> & args) {
+        return genInlineCompare(node, args, CmpInst::ICMP_EQ);
+    }
+
+    Value * ScmCodeGen::genInline(ScmEqFunc *, const vector<Value*> & args) {
+        // Symbols are interned, fixnums are immediate values
+        // and there is one object of each of '(), #t and #f
+        return genBoolean(builder.CreateICmpEQ(args[0], args[1]));
+    }
+
+    Value * ScmCodeGen::genInline(ScmVecRefFunc * node, const vector<Value*> & args) {
+        Value * vec = args[0];
+        Value * idx = args[1];
+        return genIfElse(
+                [this, vec, idx] () {
+                    return builder.CreateAnd(genTagEquals(vec, S_VEC), genIsFixnum(idx));
+                },
+                [this, node, vec, idx] () {
+                    Value * v = builder.CreateBitCast(vec, PointerType::get(t.scm_vec, 0));
+                    Value * i = builder.CreatePtrToInt(idx, builder.getInt64Ty());
+                    i = builder.CreateAShr(i, FIXNUM_SHIFT);
+
+                    vector<Value*> size_indices = { builder.getInt32(0), builder.getInt32(1) };
+                    Value * size = builder.CreateLoad(t.ti32, builder.CreateGEP(v, size_indices));
+                    size = builder.CreateSExt(size, builder.getInt64Ty());
+
+                    return genIfElse(
+                            [this, i, size] () {
+                                // Unsigned comparison catches negative indices too
+                                return builder.CreateICmpULT(i, size);
+                            },
+                            [this, v, i] () {
+                                vector<Value*> elem_indices = { builder.getInt32(0), builder.getInt32(2), i };
+                                return builder.CreateLoad(t.scm_type_ptr, builder.CreateGEP(v, elem_indices));
+                            },
+                            [this, node, vec, idx] () {
+                                return genNativeCall(node, { vec, idx });
+                            }
+                    );
+                },
+                [this, node, vec, idx] () {
+                    return genNativeCall(node, { vec, idx });
+                }
+        );
+    }
+
+    Value * ScmConsFunc::genInline(ScmCodeGen * cg, const vector<Value*> & args) {
+        return cg->genInline(this, args);
+    }
+
+    Value * ScmCarFunc::genInline(ScmCodeGen * cg, const vector<Value*> & args) {
+        return cg->genInline(this, args);
+    }
+
+    Value * ScmCdrFunc::genInline(ScmCodeGen * cg, const vector<Value*> & args) {
+        return cg->genInline(this, args);
+    }
+
+    Value * ScmNullFunc::genInline(ScmCodeGen * cg, const vector<Value*> & args) {
+        return cg->genInline(this, args);
+    }
+
+    Value * ScmPlusFunc::genInline(ScmCodeGen * cg, const vector<Value*> & args) {
+        return cg->genInline(this, args);
+    }
+
+    Value * ScmMinusFunc::genInline(ScmCodeGen * cg, const vector<Value*> & args) {
+        return cg->genInline(this, args);
+    }
+
+    Value * ScmTimesFunc::genInline(ScmCodeGen * cg, const vector<Value*> & args) {
+        return cg->genInline(this, args);
+    }
+
+    Value * ScmDivFunc::genInline(ScmCodeGen * cg, const vector<Value*> & args) {
+        return cg->genInline(this, args);
+    }
+
+    Value * ScmGtFunc::genInline(ScmCodeGen * cg, const vector<Value*> & args) {
+        return cg->genInline(this, args);
+    }
+
+    Value * ScmLtFunc::genInline(ScmCodeGen * cg, const vector<Value*> & args) {
+        return cg->genInline(this, args);
+    }
+
+    Value * ScmLeFunc::genInline(ScmCodeGen * cg, const vector<Value*> & args) {
+        return cg->genInline(this, args);
+    }
+
+    Value * ScmGeFunc::genInline(ScmCodeGen * cg, const vector<Value*> & args) {
+        return cg->genInline(this, args);
+    }
+
+    Value * ScmNumEqFunc::genInline(ScmCodeGen * cg, const vector<Value*> & args) {
+        return cg->genInline(this, args);
+    }
+
+    Value * ScmEqFunc::genInline(ScmCodeGen * cg, const vector<Value*> & args) {
+        return cg->genInline(this, args);
+    }
+
+    Value * ScmVecRefFunc::genInline(ScmCodeGen * cg, const vector<Value*> & args) {
+        return cg->genInline(this, args);
+    }
+
     any_ptr ScmCodeGen::visit(ScmInt * node) {
         D(cerr << "VISITED ScmInt!" << endl);
+        if (node->val >= FIXNUM_MIN && node->val <= FIXNUM_MAX) {
+            // No need for a global object, the value is encoded in the pointer
+            return node->IR_val = genFixnumConstant(node->val);
+        }
         Constant * c = getScmConstant<S_INT>(node->val);
         /*return node->IR_val = new GlobalVariable(
                 *module, t.scm_int, true,
@@ -504,35 +938,17 @@ namespace llscm {
 
     any_ptr ScmCodeGen::visit(ScmTrue * node) {
         D(cerr << "VISITED ScmTrue!" << endl);
-        Constant * c = getScmConstant<S_TRUE>();
-        /*return node->IR_val = new GlobalVariable(
-                *module, t.scm_type, true,
-                GlobalValue::InternalLinkage,
-                c, ""
-        );*/
-        return node->IR_val = genGlobalConstant(c);
+        return node->IR_val = genRuntimeConstant(RuntimeSymbol::true_obj);
     }
 
     any_ptr ScmCodeGen::visit(ScmFalse * node) {
         D(cerr << "VISITED ScmFalse!" << endl);
-        Constant * c = getScmConstant<S_FALSE>();
-        /*return node->IR_val = new GlobalVariable(
-                *module, t.scm_type, true,
-                GlobalValue::InternalLinkage,
-                c, ""
-        );*/
-        return node->IR_val = genGlobalConstant(c);
+        return node->IR_val = genRuntimeConstant(RuntimeSymbol::false_obj);
     }
 
     any_ptr ScmCodeGen::visit(ScmNull * node) {
         D(cerr << "VISITED ScmNull!" << endl);
-        Constant * c = getScmConstant<S_NIL>();
-        /*return node->IR_val = new GlobalVariable(
-                *module, t.scm_type, true,
-                GlobalValue::InternalLinkage,
-                c, ""
-        );*/
-        return node->IR_val = genGlobalConstant(c);
+        return node->IR_val = genRuntimeConstant(RuntimeSymbol::null_obj);
     }
 
     any_ptr ScmCodeGen::visit(ScmStr * node) {
@@ -552,13 +968,40 @@ namespace llscm {
         D(cerr << "VISITED ScmSym!" << endl);
         // Each string has a different type according to its length.
         // That type must match with the global variable type.
+        // Symbols are interned. All modules share one object
+        // per symbol name which is also registered with the runtime.
+        string sym_name = SCM_SYM_PREFIX + node->val;
+        GlobalVariable * sym = module->getNamedGlobal(sym_name);
+        if (sym) {
+            return node->IR_val = sym;
+        }
+
         Constant * c = getScmConstant<S_SYM>(node->val);
         Type * str_type = c->getAggregateElement(2)->getType();
-        return node->IR_val = new GlobalVariable(
-                *module, getScmStrType(str_type), true,
-                GlobalValue::InternalLinkage,
-                c, ""
-        );
+
+        if (btype == BuildType::EXPR) {
+            // Code compiled by eval uses the runtime's own copy (resolved by the JIT)
+            sym = new GlobalVariable(
+                    *module, getScmStrType(str_type), true,
+                    GlobalValue::ExternalLinkage,
+                    nullptr, sym_name
+            );
+        }
+        else {
+            // Weak definitions get merged by the (dynamic) linker
+            sym = new GlobalVariable(
+                    *module, getScmStrType(str_type), true,
+                    GlobalValue::WeakAnyLinkage,
+                    c, sym_name
+            );
+            static_syms.push_back(sym);
+            sym_slots[sym] = new GlobalVariable(
+                    *module, t.scm_type_ptr, false,
+                    GlobalValue::InternalLinkage,
+                    ConstantExpr::getBitCast(sym, t.scm_type_ptr), ""
+            );
+        }
+        return node->IR_val = sym;
     }
 
     any_ptr ScmCodeGen::visit(ScmRef * node) {
@@ -580,6 +1023,9 @@ namespace llscm {
             // Get context pointer of the current function
             ScmFunc * curr_func = node->defined_in_func;
             assert(curr_func);
+            if (flat_closures) {
+                return genFlatLoad(curr_func, robj.get());
+            }
             Value * heap_st = curr_func->IR_context_ptr;
             assert(heap_st);
 
@@ -613,11 +1059,23 @@ namespace llscm {
 
             assert(fn_obj->IR_wrapper_fn_ptr);
 
+            if (fn_obj->is_native && fn_obj->argc_expected != ArgsAnyCount) {
+                // Indirect calls with a known number of arguments use fastcc
+                func = genNativeTrampoline(fn_obj, func);
+            }
+
             if (fn_obj->has_closure) {
                 ScmFunc * curr_func = node->defined_in_func;
+                Value * ctxptr = flat_closures
+                        ? genFlatRecord(curr_func, fn_obj, curr_func->stack_closures)
+                        : curr_func->IR_heap_storage;
 
+                if (curr_func->stack_closures) {
+                    return genStackFunc(fn_obj->argc_expected, func,
+                                        fn_obj->IR_wrapper_fn_ptr, ctxptr);
+                }
                 return genAllocFunc(fn_obj->argc_expected, func,
-                                    fn_obj->IR_wrapper_fn_ptr, curr_func->IR_heap_storage);
+                                    fn_obj->IR_wrapper_fn_ptr, ctxptr);
             }
             else {
                 return genConstFunc(fn_obj->argc_expected, func, fn_obj->IR_wrapper_fn_ptr);
@@ -659,11 +1117,24 @@ namespace llscm {
         assert(cdr);
 
         Constant * c = getScmConstant<S_CONS>(car, cdr);
-        return node->IR_val = new GlobalVariable(
-                *module, t.scm_cons, true,
+        // The symbol fields are rewritten by genSymbolInit
+        GlobalVariable * car_sym = dyn_cast<GlobalVariable>(car);
+        GlobalVariable * cdr_sym = dyn_cast<GlobalVariable>(cdr);
+        bool car_fixup = car_sym && sym_slots.count(car_sym);
+        bool cdr_fixup = cdr_sym && sym_slots.count(cdr_sym);
+
+        GlobalVariable * cons = new GlobalVariable(
+                *module, t.scm_cons, !car_fixup && !cdr_fixup,
                 GlobalValue::InternalLinkage,
                 c, ""
         );
+        if (car_fixup) {
+            sym_fields.push_back({ cons, 1, car_sym });
+        }
+        if (cdr_fixup) {
+            sym_fields.push_back({ cons, 2, cdr_sym });
+        }
+        return node->IR_val = cons;
     }
 
     Value * ScmCodeGen::genConstFunc(int32_t argc, Function * fnptr, Function * wrfnptr) {
@@ -688,6 +1159,18 @@ namespace llscm {
         );
     }
 
+    Value * ScmCodeGen::genStackFunc(int32_t argc, Function * fnptr,
+                                     Function * wrfnptr, Value * ctxptr) {
+        assert(ctxptr);
+        // The closure object doesn't escape the current function.
+        Value * obj = genEntryAlloca(t.scm_func, 1);
+
+        builder.CreateStore(getScmConstant<S_FUNC>(argc, fnptr, wrfnptr), obj);
+        builder.CreateStore(ctxptr, builder.CreateStructGEP(t.scm_func, obj, 4));
+
+        return builder.CreateBitCast(obj, t.scm_type_ptr);
+    }
+
     Value * ScmCodeGen::genAllocHeapStorage(int32_t size) {
         // size is the number of objects we need to
         // store on the heap for the current function
@@ -700,6 +1183,74 @@ namespace llscm {
         );
     }
 
+    Value * ScmCodeGen::genEntryAlloca(Type * type, int32_t size) {
+        // The slot is allocated once in the entry block,
+        // even if the current code runs in a loop.
+        BasicBlock & entry = builder.GetInsertBlock()->getParent()->getEntryBlock();
+        IRBuilder<> entry_builder(&entry, entry.begin());
+        return entry_builder.CreateAlloca(type, builder.getInt32((uint32_t)size));
+    }
+
+    Value * ScmCodeGen::genFlatRecord(ScmFunc * curr_func, ScmFunc * fn_obj, bool on_stack) {
+        // Copies the free variables of fn_obj into a new closure record.
+        // They are either locals of the current function or fields of its own record.
+        const vector<ScmObj*> & vars = flat.freeVars(fn_obj);
+        int32_t size = max((int32_t)vars.size(), 1);
+        Value * rec = on_stack
+                ? genEntryAlloca(t.scm_type_ptr, size)
+                : genAllocHeapStorage(size);
+
+        for (size_t i = 0; i < vars.size(); i++) {
+            ScmObj * var = vars[i];
+            Value * val;
+
+            if (var->defined_in_func == curr_func) {
+                auto idx_it = curr_func->heap_local_idx.find(var);
+                assert(idx_it != curr_func->heap_local_idx.end());
+                if (flat.isBoxed(var)) {
+                    // Pointer to the heap storage slot
+                    val = builder.CreateGEP(curr_func->IR_heap_storage,
+                                            builder.getInt32((uint32_t)idx_it->second));
+                }
+                else {
+                    val = genHeapLoad(curr_func->IR_heap_storage, idx_it->second);
+                }
+            }
+            else {
+                // Value or box from the record of the current function
+                val = genHeapLoad(curr_func->IR_context_ptr, flat.index(curr_func, var));
+            }
+            genHeapStore(rec, val, (int32_t)i);
+        }
+
+        return rec;
+    }
+
+    Value * ScmCodeGen::genFlatLoad(ScmFunc * curr_func, ScmObj * var) {
+        if (var->defined_in_func == curr_func) {
+            auto idx_it = curr_func->heap_local_idx.find(var);
+            assert(idx_it != curr_func->heap_local_idx.end());
+            return genHeapLoad(curr_func->IR_heap_storage, idx_it->second);
+        }
+
+        // Single load from the closure record
+        assert(curr_func->IR_context_ptr);
+        Value * val = genHeapLoad(curr_func->IR_context_ptr, flat.index(curr_func, var));
+        if (flat.isBoxed(var)) {
+            Value * box = builder.CreateBitCast(val, PointerType::get(t.scm_type_ptr, 0));
+            val = builder.CreateLoad(box);
+        }
+        return val;
+    }
+
+    Value * ScmCodeGen::genStackHeapStorage(int32_t size) {
+        // Must be called in the entry block
+        return builder.CreateAlloca(
+                t.scm_type_ptr, builder.getInt32((uint32_t)size),
+                "__heap_storage"
+        );
+    }
+
     void ScmCodeGen::genHeapStore(Value * hs, Value * obj, int32_t idx) {
         Value * hs_idx = builder.CreateGEP(hs, builder.getInt32((uint32_t)idx));
         builder.CreateStore(builder.CreateBitCast(obj, t.scm_type_ptr), hs_idx);
@@ -741,7 +1292,7 @@ namespace llscm {
             }
         }
 
-        if (node->has_closure) {
+        if (!node->is_native) {
             // Also pass the context pointer
             Value * arg_idx = builder.CreateGEP(
                     arg_list, builder.getInt32((uint32_t)i)
@@ -750,7 +1301,9 @@ namespace llscm {
             arg_val = builder.CreateBitCast(arg_val, PointerType::get(t.scm_type_ptr, 0));
             args.push_back(arg_val);
         }
-        builder.CreateRet(builder.CreateCall(func, args));
+        CallInst * call = builder.CreateCall(func, args);
+        call->setCallingConv(func->getCallingConv());
+        builder.CreateRet(call);
         builder.restoreIP(saved_ip);
     }
 
@@ -777,10 +1330,9 @@ namespace llscm {
         else {
             arg_types.insert(arg_types.end(), (uint32_t)node->argc_expected, t.scm_type_ptr);
             // Changed the convention to pass context pointer as the last argument.
-            // Then we can used it for varargs calls as an argument end mark instead of
-            // passing the i32 with argc. That way all the function types will be compatible
-            // with this new default type: %scm_type* (%scm_type*, ...)*.
-            if (node->has_closure) {
+            // Compiled Scheme functions always take it (null if there is no closure),
+            // so an indirect call doesn't have to know whether the callee is a closure.
+            if (!node->is_native) {
                 arg_types.push_back(PointerType::get(t.scm_type_ptr, 0));
             }
         }
@@ -798,6 +1350,12 @@ namespace llscm {
                 node->name, module.get()
         );
 
+        if (!node->is_native) {
+            // Scheme to Scheme calls use fastcc, which guarantees
+            // proper tail calls together with the -tailcallopt option
+            func->setCallingConv(CallingConv::Fast);
+        }
+
         // Save function declaration
         node->IR_val = func;
 
@@ -808,14 +1366,28 @@ namespace llscm {
             return func;
         }
 
+        markTailCalls(node);
+        node->stack_closures = escape.stackAllocClosures(node);
+
         BasicBlock * bb = BasicBlock::Create(context, "entry", func);
         Value * ret_val, * c_ret_val;
         builder.SetInsertPoint(bb);
 
-        // Generate code for heap storage allocation
-        if (node->passing_closure || heap_local_idx.size() > 0) {
+        // Generate code for heap storage allocation.
+        // With flat closures, the parent pointer is not needed and the heap
+        // storage is only referenced by the boxes of the defined variables.
+        if (flat_closures && heap_local_idx.size() > 0) {
+            int32_t hs_size = (int32_t)heap_local_idx.size() + 1;
             heap_storage = node->IR_heap_storage =
-                    genAllocHeapStorage((int32_t)heap_local_idx.size() + 1);
+                    node->stack_closures || !flat.hasBoxedLocals(node)
+                    ? genStackHeapStorage(hs_size)
+                    : genAllocHeapStorage(hs_size);
+        }
+        else if (!flat_closures && (node->passing_closure || heap_local_idx.size() > 0)) {
+            int32_t hs_size = (int32_t)heap_local_idx.size() + 1;
+            heap_storage = node->IR_heap_storage = node->stack_closures
+                    ? genStackHeapStorage(hs_size)
+                    : genAllocHeapStorage(hs_size);
         }
 
         auto arg_it = func->args().begin();
@@ -846,7 +1418,7 @@ namespace llscm {
         if (node->has_closure) {
             // Last argument is the context pointer
             node->IR_context_ptr = arg_it++;
-            if (node->passing_closure) {
+            if (node->passing_closure && !flat_closures) {
                 // Store context pointer to the heap storage at 0th index.
                 genHeapStore(heap_storage, node->IR_context_ptr, 0);
             }
@@ -855,6 +1427,16 @@ namespace llscm {
             node->IR_context_ptr = nullptr;
         }
 
+        // Self tail calls become jumps to the beginning of the body.
+        // The argument values live in phi nodes, fixnum counters
+        // therefore stay in registers. Functions with heap storage
+        // would have to re-initialize it, so we leave them to the
+        // tail call elimination pass.
+        if (node->has_self_tail_call && !node->has_closure && !node->passing_closure
+            && heap_local_idx.empty() && node->argc_expected != ArgsAnyCount) {
+            genTailRecLoop(node, bb);
+        }
+
         DPC<ScmCons>(node->body_list)->each([this, &ret_val](P_ScmObj e) {
             ret_val = codegen(e);
         });
@@ -862,8 +1444,22 @@ namespace llscm {
         builder.CreateRet(c_ret_val);
         verifyFunction(*func, &errs());
 
-        // Perform optimizations
-        passman->run(*func);
+        // The passes may delete the calls (and the addresses may be reused)
+        for (auto vals: { &fixnum_vals, &bool_vals }) {
+            for (auto it = vals->begin(); it != vals->end();) {
+                if (cast<Instruction>(*it)->getParent()->getParent() == func) {
+                    it = vals->erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+
+        // Quick cleanup of each function, the rest is done by optimizeModule
+        if (optlevel > 0) {
+            passman->run(*func);
+        }
 
         builder.restoreIP(saved_ip);
 
@@ -871,6 +1467,94 @@ namespace llscm {
         return func;
     }
 
+    FunctionType * ScmCodeGen::getSchemeFnType(int32_t argc) {
+        vector<Type*> arg_types((uint32_t)argc, t.scm_type_ptr);
+        arg_types.push_back(PointerType::get(t.scm_type_ptr, 0));
+        return FunctionType::get(t.scm_type_ptr, arg_types, false);
+    }
+
+    Function * ScmCodeGen::genNativeTrampoline(ScmFunc * fn_obj, Function * native) {
+        // Adapter with the Scheme calling convention for a native
+        // function which is passed around as a scm_func object
+        string name = "__scm_tramp." + fn_obj->name;
+        Function * tramp = module->getFunction(name);
+        if (tramp) {
+            return tramp;
+        }
+
+        tramp = Function::Create(
+                getSchemeFnType(fn_obj->argc_expected),
+                GlobalValue::LinkOnceODRLinkage,
+                name, module.get()
+        );
+        tramp->setCallingConv(CallingConv::Fast);
+
+        auto saved_ip = builder.saveIP();
+        BasicBlock * bb = BasicBlock::Create(context, "entry", tramp);
+        builder.SetInsertPoint(bb);
+
+        vector<Value*> args;
+        auto arg_it = tramp->args().begin();
+        for (int32_t i = 0; i < fn_obj->argc_expected; i++) {
+            args.push_back(&*arg_it++);
+        }
+        builder.CreateRet(builder.CreateCall(native, args));
+        builder.restoreIP(saved_ip);
+
+        return tramp;
+    }
+
+    Value * ScmCodeGen::genTailReturn(CallInst * call) {
+        // The call result is returned right away. Marked as tail call
+        // with matching calling conventions, the stack frame is reused.
+        call->setTailCall();
+        builder.CreateRet(call);
+
+        BasicBlock * dead_bb = BasicBlock::Create(
+                context, "tailcall.dead", builder.GetInsertBlock()->getParent()
+        );
+        builder.SetInsertPoint(dead_bb);
+
+        return UndefValue::get(t.scm_type_ptr);
+    }
+
+    void ScmCodeGen::genTailRecLoop(ScmFunc * node, BasicBlock * entry_bb) {
+        Function * func = entry_bb->getParent();
+        BasicBlock * loop_bb = BasicBlock::Create(context, "tailrec", func);
+        builder.CreateBr(loop_bb);
+        builder.SetInsertPoint(loop_bb);
+
+        node->IR_loop_header = loop_bb;
+        node->IR_loop_args.clear();
+
+        if (node->argc_expected) {
+            DPC<ScmCons>(node->arg_list)->each([this, node, entry_bb](P_ScmObj e) {
+                P_ScmObj fn_arg = DPC<ScmRef>(e)->refObj();
+                PHINode * phi = builder.CreatePHI(t.scm_type_ptr, 2);
+                phi->addIncoming(fn_arg->IR_val, entry_bb);
+                fn_arg->IR_val = phi;
+                node->IR_loop_args.push_back(phi);
+            });
+        }
+    }
+
+    Value * ScmCodeGen::genSelfTailCall(ScmFunc * fn_obj, const vector<Value*> & args) {
+        BasicBlock * curr_bb = builder.GetInsertBlock();
+        assert(args.size() == fn_obj->IR_loop_args.size());
+
+        for (size_t i = 0; i < args.size(); i++) {
+            fn_obj->IR_loop_args[i]->addIncoming(args[i], curr_bb);
+        }
+        builder.CreateBr(fn_obj->IR_loop_header);
+
+        // The rest of the expression is never executed. We continue
+        // in an unreachable block which gets removed by SimplifyCFG.
+        BasicBlock * dead_bb = BasicBlock::Create(context, "tailrec.dead", curr_bb->getParent());
+        builder.SetInsertPoint(dead_bb);
+
+        return UndefValue::get(t.scm_type_ptr);
+    }
+
     vector<Value*> ScmCodeGen::genArgValues(const ScmCall * node) {
         vector<Value*> args;
         if (node->arg_list->t != T_NULL) {
@@ -903,18 +1587,16 @@ namespace llscm {
             // then it will check the expected and given number of arguments and finally
             // it will call the function poiner or throw a runtime error.
             Value * func = builder.CreateBitCast(obj, PointerType::get(t.scm_func, 0));
+            vector<Value *> args = genArgValues(node);
 
             Value * ret = genIfElse(
                     [this, obj] () { // IF the object tag equals S_FUNC
                         D(cerr << "loading tag" << endl);
-                        vector<Value*> tag_indices(2, builder.getInt32(0));
-                        Value * tag = builder.CreateLoad(
-                                t.ti32, builder.CreateGEP(obj, tag_indices)
-                        );
+                        Value * tag = genGetTag(obj);
 
                         return builder.CreateICmpEQ(tag, builder.getInt32(S_FUNC));
                     },
-                    [this, func, node] () { // obj is FUNC
+                    [this, func, node, &args] () { // obj is FUNC
                         vector<Value*> argc_indices = {
                                 builder.getInt32(0),
                                 builder.getInt32(1)
@@ -925,30 +1607,30 @@ namespace llscm {
 
                         Value * argc_given = builder.getInt32((uint32_t)node->argc);
 
-                        return genIfElse( // IF the func's number of args equals args_given or ArgsAnyCount
-                                [this, func, node, argc, argc_given] () {
+                        vector<Value *> fnptr_indices = {
+                                builder.getInt32(0),
+                                builder.getInt32(2)
+                        };
+                        vector<Value *> ctxptr_indices = {
+                                builder.getInt32(0),
+                                builder.getInt32(4)
+                        };
+
+                        return genIfElse( // IF the func's number of args equals args_given
+                                [this, argc, argc_given] () {
                                     D(cerr << "loading argc" << endl);
-                                    return builder.CreateOr(
-                                            builder.CreateICmpEQ(argc, argc_given),
-                                            builder.CreateICmpEQ(argc, builder.getInt32((uint32_t)ArgsAnyCount))
-                                    );
+                                    return builder.CreateICmpEQ(argc, argc_given);
                                 },
-                                [this, func, node] () { // FUNC has the right number of arguments
+                                [this, func, node, &args, fnptr_indices, ctxptr_indices] () {
+                                    // Fixed number of arguments: the callee is either
+                                    // a Scheme function or a native trampoline (both fastcc)
                                     D(cerr << "prepare to emit indirect call" << endl);
-                                    // Emit the indirect call
-                                    vector<Value *> fnptr_indices = {
-                                            builder.getInt32(0),
-                                            builder.getInt32(2)
-                                    };
-                                    vector<Value *> ctxptr_indices = {
-                                            builder.getInt32(0),
-                                            builder.getInt32(4)
-                                    };
-
                                     D(cerr << "loading fnptr" << endl);
+                                    FunctionType * fn_type = getSchemeFnType(node->argc);
                                     Value *fnptr = builder.CreateLoad(
                                             t.scm_fn_ptr, builder.CreateGEP(func, fnptr_indices)
                                     );
+                                    fnptr = builder.CreateBitCast(fnptr, PointerType::get(fn_type, 0));
 
                                     D(cerr << "loading ctxptr" << endl);
                                     Value *ctxptr = builder.CreateLoad(
@@ -956,17 +1638,41 @@ namespace llscm {
                                             builder.CreateGEP(func, ctxptr_indices)
                                     );
 
-                                    vector<Value *> args = genArgValues(node);
-                                    // We have to cast ctxptr to scm_type*
-                                    // in case we pass it as the first argument.
-                                    ctxptr = builder.CreateBitCast(ctxptr, t.scm_type_ptr);
-                                    args.push_back(ctxptr); // This is null for non-closure functions
+                                    vector<Value *> call_args = args;
+                                    call_args.push_back(ctxptr); // This is null for non-closure functions
+
+                                    CallInst * call = builder.CreateCall(fn_type, fnptr, call_args);
+                                    call->setCallingConv(CallingConv::Fast);
 
-                                    return builder.CreateCall(t.scm_fn_sig, fnptr, args);
+                                    if (node->tail_call) {
+                                        return genTailReturn(call);
+                                    }
+                                    return (Value*)call;
                                 },
-                                [this, func, argc, argc_given] { // ELSE Error: wrong number of arguments
-                                    builder.CreateCall(fn.error_wrong_arg_num, { func, argc_given });
-                                    return ConstantPointerNull::get(t.scm_type_ptr);
+                                [this, func, node, &args, argc, argc_given, fnptr_indices] () {
+                                    return genIfElse( // IF the func takes any number of args
+                                            [this, argc] () {
+                                                return builder.CreateICmpEQ(
+                                                        argc, builder.getInt32((uint32_t)ArgsAnyCount)
+                                                );
+                                            },
+                                            [this, func, &args, fnptr_indices] () {
+                                                // Native varargs function (C calling convention)
+                                                Value *fnptr = builder.CreateLoad(
+                                                        t.scm_fn_ptr, builder.CreateGEP(func, fnptr_indices)
+                                                );
+
+                                                vector<Value *> call_args = args;
+                                                // Null terminates the argument list
+                                                call_args.push_back(ConstantPointerNull::get(t.scm_type_ptr));
+
+                                                return builder.CreateCall(t.scm_fn_sig, fnptr, call_args);
+                                            },
+                                            [this, func, argc_given] () { // ELSE Error: wrong number of arguments
+                                                builder.CreateCall(fn.error_wrong_arg_num, { func, argc_given });
+                                                return ConstantPointerNull::get(t.scm_type_ptr);
+                                            }
+                                    );
                                 }
                         );
                     },
@@ -989,6 +1695,15 @@ namespace llscm {
 
             vector<Value*> args = genArgValues(node);
 
+            if (node->self_tail_call && fn_obj->IR_loop_header) {
+                return node->IR_val = genSelfTailCall(fn_obj, args);
+            }
+
+            // Primitives may be expanded at the call site
+            if (Value * inl = fn_obj->genInline(this, args)) {
+                return node->IR_val = inl;
+            }
+
             if (fn_obj->has_closure) {
                 // We must also count with the case of direct closure function call.
                 // There's no need to allocate scm_func object, we're not passing
@@ -996,9 +1711,25 @@ namespace llscm {
                 // It must be the current function. Closure with any other context
                 // would have to be defined elsewhere and passed as a scm_func struct
                 // which would then lead to an indirect call.
-                assert(fn_ref->defined_in_func);
-                D(cerr << fn_ref->defined_in_func << endl);
-                args.push_back(fn_ref->defined_in_func->IR_heap_storage);
+                ScmFunc * curr_func = fn_ref->defined_in_func;
+                assert(curr_func);
+                D(cerr << curr_func << endl);
+                if (fn_obj == curr_func) {
+                    // Recursive call gets the same context
+                    args.push_back(curr_func->IR_context_ptr);
+                }
+                else if (flat_closures) {
+                    // The record can't be on the stack if the frame is reused
+                    args.push_back(genFlatRecord(curr_func, fn_obj, !node->tail_call));
+                }
+                else {
+                    args.push_back(curr_func->IR_heap_storage);
+                }
+            }
+            else if (!fn_obj->is_native) {
+                args.push_back(ConstantPointerNull::get(
+                        PointerType::get(t.scm_type_ptr, 0)
+                ));
             }
 
             if (fn_obj->argc_expected == ArgsAnyCount) {
@@ -1011,7 +1742,19 @@ namespace llscm {
                 }
             }
 
-            return node->IR_val = builder.CreateCall(func, args, fn_obj->name);
+            CallInst * call = builder.CreateCall(func, args, fn_obj->name);
+            call->setCallingConv(func->getCallingConv());
+
+            if (node->tail_call && !fn_obj->is_native) {
+                return node->IR_val = genTailReturn(call);
+            }
+            if (fn_obj->facts & FN_RET_FIXNUM) {
+                fixnum_vals.insert(call);
+            }
+            if (fn_obj->facts & FN_RET_BOOL) {
+                bool_vals.insert(call);
+            }
+            return node->IR_val = call;
         }
     }
 
@@ -1022,7 +1765,7 @@ namespace llscm {
             ScmFunc * fn = DPC<ScmFunc>(node->val).get();
             if (!StringRef(fn->name).startswith("__lambda#") && btype != BuildType::EXEC) {
                 // Metadata saved only for global named functions
-                output_meta.addRecord(fn->argc_expected, fn->name);
+                output_meta.addFunction(fn->name, fn->argc_expected, fn->facts, escape.noEscapeMask(fn));
             }
         }
         if (node->val->t == T_FUNC || node->val->t == T_REF) {
@@ -1050,6 +1793,9 @@ namespace llscm {
 
             // Save expr to global var
             builder.CreateStore(expr, gvar);
+            if (btype != BuildType::EXEC) {
+                output_meta.addGlobal(defname->val);
+            }
             node->val->IR_val = gvar;
             node->val->exported_name = defname->val;
         }
@@ -1071,9 +1817,7 @@ namespace llscm {
     any_ptr ScmCodeGen::visit(ScmIfSyntax * node) {
         D(cerr << "VISITED ScmIfSyntax!" << endl);
         Value * cond = codegen(node->cond_expr);
-        vector<Value*> indices(2, builder.getInt32(0));
-        Value * cond_arg_addr = builder.CreateGEP(cond, indices);
-        Value * cond_tag = builder.CreateLoad(cond_arg_addr);
+        Value * cond_tag = genGetTag(cond);
         cond = builder.CreateICmpNE(cond_tag, builder.getInt32(S_FALSE));
 
         Function * func = builder.GetInsertBlock()->getParent();
@@ -1158,7 +1902,30 @@ namespace llscm {
 
     any_ptr ScmCodeGen::visit(ScmQuoteSyntax * node) {
         D(cerr << "VISITED ScmQuoteSyntax!" << endl);
-        return node->IR_val = codegen(node->data);
+        Value * data = codegen(node->data);
+        GlobalVariable * sym = dyn_cast<GlobalVariable>(data);
+        auto slot = sym ? sym_slots.find(sym) : sym_slots.end();
+        if (slot != sym_slots.end()) {
+            return node->IR_val = builder.CreateLoad(slot->second);
+        }
+        return node->IR_val = data;
+    }
+
+    void ScmCodeGen::genSymbolInit(BasicBlock * bb) {
+        // The runtime must know our symbols before any of them
+        // can be compared with those created by read or string->symbol.
+        // If it already has an object of the same name, we use that one.
+        builder.SetInsertPoint(bb, bb->getFirstInsertionPt());
+        unordered_map<GlobalVariable*, Value*> interned;
+        for (auto sym: static_syms) {
+            Value * obj = builder.CreateCall(fn.intern_static_sym, { builder.CreateBitCast(sym, t.scm_type_ptr) });
+            builder.CreateStore(obj, sym_slots[sym]);
+            interned[sym] = obj;
+        }
+        for (auto & f: sym_fields) {
+            vector<Value*> indices = { builder.getInt32(0), builder.getInt32(f.field) };
+            builder.CreateStore(interned[f.sym], builder.CreateGEP(f.cons, indices));
+        }
     }
 
     Value * ScmCodeGen::genAndExpr(ScmCons * cell) {
@@ -1170,14 +1937,11 @@ namespace llscm {
         return genIfElse(
                 [this, cell] () {
                     Value * expr = codegen(cell->car);
-                    vector<Value*> indices(2, builder.getInt32(0));
-                    Value * expr_arg_addr = builder.CreateGEP(expr, indices);
-                    Value * expr_tag = builder.CreateLoad(expr_arg_addr);
+                    Value * expr_tag = genGetTag(expr);
                     return builder.CreateICmpEQ(expr_tag, builder.getInt32(S_FALSE));
                 },
                 [this] () {
-                    Constant * c = getScmConstant<S_FALSE>();
-                    return genGlobalConstant(c);
+                    return genRuntimeConstant(RuntimeSymbol::false_obj);
                 },
                 [this, cell] () {
                     return genAndExpr(DPC<ScmCons>(cell->cdr).get());
@@ -1189,8 +1953,7 @@ namespace llscm {
         D(cerr << "VISITED ScmAndSyntax!" << endl);
         ScmCons * expr_list = DPC<ScmCons>(node->expr_list).get();
         if (!expr_list) {
-            Constant * c = getScmConstant<S_TRUE>();
-            return node->IR_val = genGlobalConstant(c);
+            return node->IR_val = genRuntimeConstant(RuntimeSymbol::true_obj);
         }
 
         return genAndExpr(expr_list);
@@ -1206,9 +1969,7 @@ namespace llscm {
         Value * expr = codegen(cell->car);
         return genIfElse(
                 [this, cell, expr] () {
-                    vector<Value*> indices(2, builder.getInt32(0));
-                    Value * expr_arg_addr = builder.CreateGEP(expr, indices);
-                    Value * expr_tag = builder.CreateLoad(expr_arg_addr);
+                    Value * expr_tag = genGetTag(expr);
                     return builder.CreateICmpNE(expr_tag, builder.getInt32(S_FALSE));
                 },
                 [this, expr] () {
@@ -1224,8 +1985,7 @@ namespace llscm {
         D(cerr << "VISITED ScmOrSyntax!" << endl);
         ScmCons * expr_list = DPC<ScmCons>(node->expr_list).get();
         if (!expr_list) {
-            Constant * c = getScmConstant<S_FALSE>();
-            return node->IR_val = genGlobalConstant(c);
+            return node->IR_val = genRuntimeConstant(RuntimeSymbol::false_obj);
         }
 
         return genOrExpr(expr_list);
@@ -1234,9 +1994,18 @@ namespace llscm {
     void ScmCodeGen::run() {
         Value * last_val;
 
+        if (flat_closures) {
+            // Must run first, it adds the context pointer to some functions
+            flat.analyze(dynamic_cast<ScmObj*>(ast));
+        }
+        escape.analyze(dynamic_cast<ScmObj*>(ast));
+        computeFacts(dynamic_cast<ScmObj*>(ast));
+
         (this->*addEntryFuncProlog)();
+        BasicBlock * init_bb = builder.GetInsertBlock();
         last_val = codegen(ast);
         (this->*addEntryFuncEpilog)(last_val);
+        genSymbolInit(init_bb);
         verifyFunction(*entry_func, &errs());
 
         if (btype != BuildType::EXEC) {
@@ -1244,11 +2013,13 @@ namespace llscm {
             // Save generated metadata array to global variable
             Constant *llsmeta = ConstantDataArray::get(context, blob);
 
-            new GlobalVariable(
+            GlobalVariable * gv = new GlobalVariable(
                     *module, llsmeta->getType(), false,
                     GlobalValue::AppendingLinkage,
                     llsmeta, "__llscheme_metainfo__"
             );
+            // The records are read in place
+            gv->setAlignment(4);
         }
 
         /*new GlobalVariable(
@@ -5,19 +5,30 @@
 #include <memory>
 #include <llvm/ADT/STLExtras.h>
 #include <llvm/ADT/StringRef.h>
-#include <llvm/Bitcode/ReaderWriter.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/FileUtilities.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/Program.h>
+#include <llvm/Support/TargetRegistry.h>
+#include <llvm/Support/TargetSelect.h>
 #include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
+#include <llvm/Transforms/Utils/Cloning.h>
 #include "../include/driver.hpp"
 #include "../include/environment.hpp"
 #include "../include/codegen.hpp"
 #include "../include/optionparser/argtypes.h"
 #include "../include/fs_helpers.hpp"
+#include "../include/lib_reader.hpp"
+#include "../include/bitcode.hpp"
 
 using namespace std;
 using namespace llvm;
 
 namespace llscm {
-	enum optionIdx { UNKNOWN, HELP, INPUT_STR, OUTPUT, FILETYPE, BUILDTYPE, OPTLEVEL };
+	enum optionIdx { UNKNOWN, HELP, INPUT_STR, OUTPUT, FILETYPE, BUILDTYPE, OPTLEVEL, CLOSURES, EMBED_BITCODE, STATIC };
 	const option::Descriptor usage[] = {
 			{ UNKNOWN, 0, "", "", Arg::Unknown,
 					"USAGE: schemec [options] [input file]\n\nOptions:" },
@@ -30,14 +41,21 @@ namespace llscm {
 			{ FILETYPE, 0, "f", "filetype", Arg::Required,
 					"  -f <type>, \t--filetype=<type>  \tOutput file type: asm, obj or null." },
 			{ BUILDTYPE, 0, "b", "buildtype", Arg::Required,
-					"  -b <type>, \t--buildtype=<type>  \tBuild type: exec or lib." },
+					"  -b <type>, \t--buildtype=<type>  \tBuild type: exec, lib or whole (exec with the required libraries linked in)." },
 			{ OPTLEVEL, 0, "O", "", Arg::Numeric,
 					"  -O <num> \t  \tOptimization level: -O0, -O1, -O2, -O3." },
+			{ CLOSURES, 0, "", "closures", Arg::Required,
+					"  \t--closures=<repr>  \tClosure representation: chained or flat." },
+			{ EMBED_BITCODE, 0, "", "embed-bitcode", Arg::None,
+					"  \t--embed-bitcode  \tEmbed the optimized bitcode for cross-module inlining." },
+			{ STATIC, 0, "", "static", Arg::None,
+					"  \t--static  \tLink a static executable with the runtime, the required libraries and the GC inside." },
 			{ 0, 0, 0, 0, 0, 0 }
 	};
 
 	const char * Options::ft_id[] = { "asm", "obj", "null" };
-	const char * Options::bt_id[] = { "exec", "lib" };
+	const char * Options::bt_id[] = { "exec", "lib", "whole" };
+	const char * Options::cl_id[] = { "chained", "flat" };
 
 	unique_ptr<Options> getOptions(const vector<option::Option> & cmdargs, option::Parser & parser) {
 		unique_ptr<Options> opts = make_unique<Options>();
@@ -54,6 +72,10 @@ namespace llscm {
 			return opts;
 		}
 
+		if (cmdargs[STATIC]) {
+			opts->setStaticLink();
+		}
+
 		if (cmdargs[INPUT_STR]) {
 			opts->setStringInput(cmdargs[INPUT_STR].arg);
 		}
@@ -84,64 +106,172 @@ namespace llscm {
 			opts->setOptLevel(cmdargs[OPTLEVEL].arg);
 		}
 
+		if (cmdargs[CLOSURES]) {
+			opts->setClosures(cmdargs[CLOSURES].arg);
+		}
+
+		if (cmdargs[EMBED_BITCODE]) {
+			opts->setEmbedBitcode();
+		}
+
+		if (!opts->resolveStaticLink()) {
+			cerr << "Error: --static produces an executable, it cannot be used with -b lib or -f." << endl;
+			opts->invalid = true;
+			return opts;
+		}
+
 		return opts;
 	}
 
-	void Driver::writeBitcodeToPipe(const shared_ptr<Module> & mod, FILE * pipe) {
-		int pipe_fd;
-		unique_ptr<raw_ostream> pipe_stream;
+	unique_ptr<TargetMachine> Driver::createTargetMachine(const string & triple) {
+		string err;
+		const Target * target = TargetRegistry::lookupTarget(triple, err);
+		if (!target) {
+			cerr << "Error: " << err << endl;
+			return nullptr;
+		}
 
-		pipe_fd = fileno(pipe);
-		pipe_stream = make_unique<raw_fd_ostream>(pipe_fd, false);
+		TargetOptions to;
+		// Guarantees proper tail calls between Scheme functions (fastcc)
+		to.GuaranteedTailCallOpt = true;
+
+		// TODO: Will this work in all cases?
+		// Probably it will, as long as all the scheme modules
+		// are compiled as position independent
+		// dynamic shared libraries except the executables.
+		Reloc::Model rm = opts->buildtype == Options::BT_LIB ? Reloc::PIC_ : Reloc::Default;
+
+		CodeGenOpt::Level ol;
+		switch (opts->optlevel) {
+			case 0: ol = CodeGenOpt::None; break;
+			case 1: ol = CodeGenOpt::Less; break;
+			case 2: ol = CodeGenOpt::Default; break;
+			default: ol = CodeGenOpt::Aggressive; break;
+		}
 
-		WriteBitcodeToFile(mod.get(), *pipe_stream);
-		fflush(pipe);
+		return unique_ptr<TargetMachine>(
+				target->createTargetMachine(triple, "", "", to, rm, CodeModel::Default, ol)
+		);
 	}
 
-	string Driver::getLLCompilerCommand() {
-		stringstream ss;
+	void Driver::importRuntimeBitcode(Module & mod) {
+		// Library functions written in Scheme can be inlined like the user-defined ones
+		auto res = getLibraryPath("libllscmrt.so");
+		LibReader dylib;
+		if (!res.second || !dylib.load(res.first)) {
+			return;
+		}
+
+		size_t size = 0;
+		const char * bitcode = (const char*)dylib.getAddressOfSymbol(EmbeddedBitcodeSym, &size);
+		if (!bitcode) {
+			D(cerr << "Runtime library without bitcode" << endl);
+			return;
+		}
+
+		if (!importBitcode(mod, StringRef(bitcode, size))) {
+			cerr << "Warning: Could not import the runtime library bitcode." << endl;
+		}
+	}
 
-		ss << "llc -";
+	bool Driver::emitOutput(const shared_ptr<Module> & mod, TargetMachine * tm, const string & out_fname) {
+		// Code generation runs in-process, the same way as in llc
+		TargetMachine::CodeGenFileType ft;
+		switch (opts->filetype) {
+			case Options::FT_ASM: ft = TargetMachine::CGFT_AssemblyFile; break;
+			case Options::FT_NULL: ft = TargetMachine::CGFT_Null; break;
+			default: ft = TargetMachine::CGFT_ObjectFile; break;
+		}
 
-		if (opts->has_output_name) {
-			ss << " -o " << opts->out_fname;
+		error_code ec;
+		raw_fd_ostream out(out_fname, ec,
+						   ft == TargetMachine::CGFT_AssemblyFile ? sys::fs::F_Text : sys::fs::F_None);
+		if (ec) {
+			cerr << "Cannot open file " << out_fname << ": " << ec.message() << endl;
+			return false;
 		}
 
-		if (opts->buildtype == Options::BT_LIB) {
-			// TODO: Will this work in all cases?
-			// Probably it will, as long as all the scheme modules
-			// are compiled as position independent
-			// dynamic shared libraries except the executables.
-			ss << " -relocation-model=pic";
+		// Object file emission needs a seekable stream
+		unique_ptr<buffer_ostream> bout;
+		raw_pwrite_stream * os = &out;
+		if (!out.supportsSeeking()) {
+			bout = make_unique<buffer_ostream>(out);
+			os = bout.get();
 		}
 
-		ss << " -filetype=" << opts->ft_id[opts->filetype];
-		ss << " -O" << opts->optlevel;
+		legacy::PassManager pm;
+		if (tm->addPassesToEmitFile(pm, *os, ft)) {
+			cerr << "Error: Target does not support this file type." << endl;
+			return false;
+		}
+		pm.run(*mod);
 
-		return ss.str();
+		return true;
 	}
 
-	bool Driver::invokeLLC(const shared_ptr<Module> & mod) {
-		string command;
-		FILE * pipe;
+	bool Driver::emitStaticExecutable(const shared_ptr<Module> & mod, TargetMachine * tm) {
+		// The static runtime is installed next to the shared one
+		auto rt = getLibraryPath("libllscmrt.a");
+		if (!rt.second) {
+			cerr << "Error: Static runtime library libllscmrt.a not found." << endl;
+			return false;
+		}
+
+		ErrorOr<string> cxx = sys::findProgramByName("c++");
+		if (!cxx) {
+			cerr << "Error: Linker driver c++ not found." << endl;
+			return false;
+		}
+
+		SmallString<128> obj_fname;
+		if (sys::fs::createTemporaryFile("llscheme", "o", obj_fname)) {
+			cerr << "Error: Cannot create a temporary object file." << endl;
+			return false;
+		}
+		FileRemover obj_remover(obj_fname);
 
-		command = getLLCompilerCommand();
-		D(cerr << "Command: " << command << endl);
+		if (!emitOutput(mod, tm, obj_fname.str())) {
+			return false;
+		}
 
-		pipe = popen(command.c_str(), "w");
-		writeBitcodeToPipe(mod, pipe);
-		pclose(pipe);
+		string out_fname = opts->has_output_name ? opts->out_fname : "a.out";
+		// The runtime is C++ (libstdc++ comes from the driver), scmlib is in the archive
+		const char * args[] = {
+				cxx->c_str(), "-static", obj_fname.c_str(), "-o", out_fname.c_str(),
+				rt.first.c_str(), "-lgc", "-lpthread", "-ldl", "-lm", nullptr
+		};
 
+		string err;
+		if (sys::ExecuteAndWait(*cxx, args, nullptr, nullptr, 0, 0, &err) != 0) {
+			cerr << "Error: Linking " << out_fname << " failed. " << err << endl;
+			return false;
+		}
 		return true;
 	}
 
-	bool Driver::compile(unique_ptr<Parser> && p) {
-		ScmProg prog = p->NT_Prog();
+	static bool isExported(const GlobalValue & gv) {
+		// Entry point and the symbols shared with the runtime library
+		StringRef name = gv.getName();
+		return name == "main" || name == RuntimeSymbol::exit_code || name == RuntimeSymbol::argv
+			   || name.startswith(SCM_SYM_PREFIX) || name.startswith("llvm.");
+	}
 
-		if (p->fail()) {
-			return false;
+	static void internalizeProgram(Module & mod) {
+		// Nothing else links against the program, so the optimizer
+		// is free to specialize or drop any of the library functions
+		for (Function & fn: mod) {
+			if (!fn.isDeclaration() && !fn.hasLocalLinkage() && !isExported(fn)) {
+				fn.setLinkage(GlobalValue::InternalLinkage);
+			}
+		}
+		for (GlobalVariable & gv: mod.globals()) {
+			if (!gv.isDeclaration() && !gv.hasLocalLinkage() && !isExported(gv)) {
+				gv.setLinkage(GlobalValue::InternalLinkage);
+			}
 		}
+	}
 
+	bool Driver::evalProgram(ScmProg & prog) {
 		shared_ptr<ScmEnv> env = createGlobalEnvironment(prog);
 
 		for (auto & e: prog) {
@@ -165,19 +295,154 @@ namespace llscm {
 			D(e->printSrc(cerr));
 			D(cerr << endl);
 		}
+		return true;
+	}
 
-		ScmCodeGen cg(getGlobalContext(), &prog);
-		if (opts->buildtype == Options::BT_EXEC) {
-			cg.makeExecutable();
+	unique_ptr<ScmCodeGen> Driver::genCode(ScmProg & prog, bool exec) {
+		unique_ptr<ScmCodeGen> cg = make_unique<ScmCodeGen>(getGlobalContext(), &prog);
+		if (exec) {
+			cg->makeExecutable();
 		} // Otherwise we're building a library (module without main function)
-		cg.run();
-		D(cg.dump());
+		if (opts->closures == Options::CL_FLAT) {
+			cg->useFlatClosures();
+		}
+		cg->setOptLevel((unsigned)opts->optlevel);
+		cg->run();
+		return cg;
+	}
 
-		invokeLLC(cg.getModule());
+	bool Driver::collectLibraries(ScmProg & prog, set<string> & seen, vector<unique_ptr<Module>> & libs) {
+		for (auto & e: prog) {
+			auto req = dynamic_cast<ScmRequire*>(e.get());
+			if (!req) {
+				continue;
+			}
+
+			string name = DPC<ScmStr>(req->lib_name)->val;
+			if (StringRef(name).endswith(".so")) {
+				name = StringRef(name).drop_back(3);
+			}
+			if (!seen.insert(name).second) {
+				continue;
+			}
+
+			// The library source is preferred, its own requirements are linked too
+			auto src = getLibraryPath(name + ".scm");
+			if (src.second) {
+				D(cerr << "Compiling library " << src.first << endl);
+				fstream fs(src.first, fstream::in);
+				if (fs.fail()) {
+					cerr << "Cannot open file " << src.first << "." << endl;
+					return false;
+				}
+
+				unique_ptr<Reader> r = make_unique<FileReader>(fs);
+				Parser p(r);
+				ScmProg lib_prog = p.NT_Prog();
+				if (p.fail() || !evalProgram(lib_prog)) {
+					return false;
+				}
+
+				// Dependencies go first, so that their constructors run first
+				if (!collectLibraries(lib_prog, seen, libs)) {
+					return false;
+				}
+
+				unique_ptr<ScmCodeGen> cg = genCode(lib_prog, false);
+				libs.push_back(CloneModule(cg->getModule().get()));
+				continue;
+			}
+
+			// Otherwise the bitcode embedded in the shared library
+			auto res = getLibraryPath(name + ".so");
+			LibReader dylib;
+			if (res.second && dylib.load(res.first)) {
+				size_t size = 0;
+				const char * bitcode = (const char*)dylib.getAddressOfSymbol(EmbeddedBitcodeSym, &size);
+				if (bitcode) {
+					D(cerr << "Using bitcode of " << res.first << endl);
+					unique_ptr<Module> lib = make_unique<Module>(name, getGlobalContext());
+					if (!linkBitcode(*lib, StringRef(bitcode, size))) {
+						cerr << "Error: Could not read the bitcode of " << res.first << "." << endl;
+						return false;
+					}
+					libs.push_back(move(lib));
+					continue;
+				}
+			}
+
+			cerr << "Error: Library " << name << " has neither the source nor the embedded bitcode." << endl;
+			return false;
+		}
+		return true;
+	}
+
+	bool Driver::linkRequiredLibraries(Module & mod, ScmProg & prog) {
+		set<string> seen;
+		vector<unique_ptr<Module>> libs;
+		if (!collectLibraries(prog, seen, libs)) {
+			return false;
+		}
+
+		for (auto & lib: libs) {
+			lib->setTargetTriple(mod.getTargetTriple());
+			lib->setDataLayout(mod.getDataLayout());
+			if (!linkLibrary(mod, move(lib))) {
+				cerr << "Error: Could not link the required libraries." << endl;
+				return false;
+			}
+		}
 
+		internalizeProgram(mod);
 		return true;
 	}
 
+	bool Driver::compile(unique_ptr<Parser> && p) {
+		ScmProg prog = p->NT_Prog();
+
+		if (p->fail()) {
+			return false;
+		}
+
+		if (!evalProgram(prog)) {
+			return false;
+		}
+
+		// The whole program build is an executable with the libraries inside
+		unique_ptr<ScmCodeGen> cg = genCode(prog, opts->buildtype != Options::BT_LIB);
+
+		string triple = sys::getDefaultTargetTriple();
+		unique_ptr<TargetMachine> tm = createTargetMachine(triple);
+		if (!tm) {
+			return false;
+		}
+
+		shared_ptr<Module> mod = cg->getModule();
+		mod->setTargetTriple(triple);
+		mod->setDataLayout(tm->createDataLayout());
+
+		if (opts->buildtype == Options::BT_WHOLE && !linkRequiredLibraries(*mod, prog)) {
+			return false;
+		}
+
+		if (opts->optlevel >= 2 && !opts->embed_bitcode) {
+			importRuntimeBitcode(*mod);
+		}
+
+		cg->optimizeModule(tm.get());
+		D(cg->dump());
+
+		if (opts->embed_bitcode) {
+			embedBitcode(*mod);
+		}
+
+		if (opts->static_link) {
+			return emitStaticExecutable(mod, tm.get());
+		}
+		// Standard output is used if there's no output name
+		return emitOutput(mod, tm.get(), opts->has_output_name ? opts->out_fname : "-");
+	}
+
 	bool Driver::compileSourceFile(const string & fname) {
 		bool st;
 
@@ -219,6 +484,9 @@ int main(int argc, char * argv[]) {
 	initExecPath(argv[0]);
 	initCWDPath();
 
+	InitializeNativeTarget();
+	InitializeNativeTargetAsmPrinter();
+
 	option::Stats stats(true, usage, argc - 1, argv + 1);
 	vector<option::Option> cmdargs(stats.options_max);
 	vector<option::Option> buffer(stats.buffer_max);
@@ -11,6 +11,13 @@ namespace llscm {
     using namespace std;
     using namespace llvm;
 
+    static shared_ptr<ScmFunc> makeNativeFunc(int32_t argc, const char * name, uint32_t facts = 0) {
+        shared_ptr<ScmFunc> func = make_shared<ScmFunc>(argc, name);
+        func->is_native = true;
+        func->facts = facts;
+        return func;
+    }
+
     void initGlobalEnvironment(ScmEnv * env, void * lib_blob) {
         env->set("cons", make_shared<ScmConsFunc>());
         env->set("car", make_shared<ScmCarFunc>());
@@ -19,7 +26,11 @@ namespace llscm {
         env->set("-", make_shared<ScmMinusFunc>());
         env->set("null?", make_shared<ScmNullFunc>());
         env->set(">", make_shared<ScmGtFunc>());
+        env->set("<", make_shared<ScmLtFunc>());
+        env->set("<=", make_shared<ScmLeFunc>());
+        env->set(">=", make_shared<ScmGeFunc>());
         env->set("=", make_shared<ScmNumEqFunc>());
+        env->set("eq?", make_shared<ScmEqFunc>());
         env->set("*", make_shared<ScmTimesFunc>());
         env->set("/", make_shared<ScmDivFunc>());
         env->set("display", make_shared<ScmDisplayFunc>());
@@ -29,29 +40,29 @@ namespace llscm {
         env->set("apply", make_shared<ScmApplyFunc>());
         env->set("length", make_shared<ScmLengthFunc>());
 
-        env->set("make-base-namespace", make_shared<ScmFunc>(0, RuntimeSymbol::make_base_nspace));
-        env->set("current-namespace", make_shared<ScmFunc>(ArgsAnyCount, RuntimeSymbol::current_nspace));
-        env->set("eval", make_shared<ScmFunc>(2, RuntimeSymbol::eval));
-        env->set("read", make_shared<ScmFunc>(0, RuntimeSymbol::read));
-        env->set("eof-object?", make_shared<ScmFunc>(1, RuntimeSymbol::is_eof));
-        env->set("list", make_shared<ScmFunc>(ArgsAnyCount, RuntimeSymbol::list));
-        env->set("string->symbol", make_shared<ScmFunc>(1, RuntimeSymbol::string_to_symbol));
-        env->set("string=?", make_shared<ScmFunc>(2, RuntimeSymbol::string_equals));
-        env->set("string-append", make_shared<ScmFunc>(2, RuntimeSymbol::string_append));
-        env->set("string-replace", make_shared<ScmFunc>(3, RuntimeSymbol::string_replace));
-        env->set("string-split", make_shared<ScmFunc>(1, RuntimeSymbol::string_split));
-        env->set("open-input-file", make_shared<ScmFunc>(1, RuntimeSymbol::open_input_file));
-        env->set("close-input-port", make_shared<ScmFunc>(1, RuntimeSymbol::close_input_port));
-        env->set("read-line", make_shared<ScmFunc>(1, RuntimeSymbol::read_line));
-        env->set("equal?", make_shared<ScmFunc>(2, RuntimeSymbol::equal));
-        env->set("exit", make_shared<ScmFunc>(1, RuntimeSymbol::exit));
-        env->set("random", make_shared<ScmFunc>(1, RuntimeSymbol::random));
-
-        // TODO: eq?
-
-        LibReader dylib;
-        Metadata input_meta;
+        env->set("make-base-namespace", makeNativeFunc(0, RuntimeSymbol::make_base_nspace));
+        env->set("current-namespace", makeNativeFunc(ArgsAnyCount, RuntimeSymbol::current_nspace));
+        env->set("eval", makeNativeFunc(2, RuntimeSymbol::eval));
+        env->set("eval-batch", makeNativeFunc(2, RuntimeSymbol::eval_batch));
+        env->set("read", makeNativeFunc(0, RuntimeSymbol::read));
+        env->set("eof-object?", makeNativeFunc(1, RuntimeSymbol::is_eof, FN_RET_BOOL));
+        env->set("list", makeNativeFunc(ArgsAnyCount, RuntimeSymbol::list));
+        env->set("string->symbol", makeNativeFunc(1, RuntimeSymbol::string_to_symbol));
+        env->set("string=?", makeNativeFunc(2, RuntimeSymbol::string_equals, FN_RET_BOOL));
+        env->set("string-append", makeNativeFunc(2, RuntimeSymbol::string_append));
+        env->set("string-replace", makeNativeFunc(3, RuntimeSymbol::string_replace));
+        env->set("string-split", makeNativeFunc(1, RuntimeSymbol::string_split));
+        env->set("open-input-file", makeNativeFunc(1, RuntimeSymbol::open_input_file));
+        env->set("close-input-port", makeNativeFunc(1, RuntimeSymbol::close_input_port));
+        env->set("read-line", makeNativeFunc(1, RuntimeSymbol::read_line));
+        env->set("equal?", makeNativeFunc(2, RuntimeSymbol::equal, FN_RET_BOOL));
+        env->set("exit", makeNativeFunc(1, RuntimeSymbol::exit));
+        env->set("random", makeNativeFunc(1, RuntimeSymbol::random));
+        env->set("collect-garbage", makeNativeFunc(0, RuntimeSymbol::collect_garbage));
+
+        shared_ptr<LibExports> lib = make_shared<LibExports>();
         void * metainfo_blob;
+        size_t metainfo_size = 0;
 
         // Load other symbols from the runtime library (those implemented in Scheme - without c headers)
         if (lib_blob) {
@@ -66,26 +77,22 @@ namespace llscm {
                 return;
             }
 
-            if (!dylib.load(res.first)) {
+            if (!lib->reader.load(res.first)) {
                 return;
             }
 
-            metainfo_blob = dylib.getAddressOfSymbol("__llscheme_metainfo__");
+            metainfo_blob = lib->reader.getAddressOfSymbol("__llscheme_metainfo__", &metainfo_size);
             if (!metainfo_blob) {
                 return;
             }
         }
 
-        if (!input_meta.loadFromBlob(metainfo_blob)) {
+        if (!lib->meta.loadFromBlob(metainfo_blob, metainfo_size)) {
             cerr << "Error: Invalid metadata in the runtime library." << endl;
             exit(EXIT_FAILURE);
         }
 
-        input_meta.foreachRecord([env](FunctionInfo *rec) {
-            D(cerr << "Found function \"" << rec->name << "\" with " << rec->argc << " args." << endl);
-            // Add the function into environment
-            env->set(rec->name, make_shared<ScmFunc>(rec->argc, rec->name));
-        });
+        env->addLibrary(lib);
     }
 
     shared_ptr<ScmEnv> createGlobalEnvironment(ScmProg & prog) {
@@ -110,6 +117,12 @@ namespace llscm {
         }
         context = nullptr;
         link_lib = false;
+        nextGeneration();
+    }
+
+    void ScmEnv::nextGeneration() {
+        static uint64_t counter = 0;
+        generation = ++counter;
     }
 
     void ScmEnv::setProg(ScmProg & p) {
@@ -151,7 +164,7 @@ namespace llscm {
             if (parent_env) {
                 return parent_env->get(sym, loc);
             }
-            return nullptr;
+            return importExport(sym);
         }
 
         if (!func && find_func && *loc) {
@@ -183,6 +196,10 @@ namespace llscm {
             return false;
         }
         binding[*sym] = obj;
+        // Anonymous functions get unique names, nothing else can refer to them
+        if (isGlobal() && !StringRef(sym->val).startswith("__lambda#")) {
+            nextGeneration();
+        }
         return true;
     }
 
@@ -192,9 +209,48 @@ namespace llscm {
             return false;
         }
         binding[*sym] = obj;
+        if (isGlobal() && !StringRef(k).startswith("__lambda#")) {
+            nextGeneration();
+        }
         return true;
     }
 
+    void ScmEnv::addLibrary(shared_ptr<LibExports> lib) {
+        top_level_env->libs.push_back(lib);
+        // Names bound by the new library may now refer to something else
+        top_level_env->nextGeneration();
+    }
+
+    P_ScmObj ScmEnv::importExport(ScmSym * sym) {
+        for (auto it = libs.rbegin(); it != libs.rend(); ++it) {
+            const Metadata & meta = (*it)->meta;
+            P_ScmObj obj;
+
+            if (const GlobalInfo * rec = meta.findGlobal(sym->val.c_str())) {
+                D(cerr << "Found global \"" << meta.name(*rec) << "\"." << endl);
+                // Accessed through the symbol exported by the library
+                obj = make_shared<ScmObj>(T_EXPR);
+                obj->location = T_GLOB;
+                obj->is_extern = true;
+                obj->exported_name = sym->val;
+            }
+            else if (const FunctionInfo * rec = meta.findFunction(sym->val.c_str())) {
+                D(cerr << "Found function \"" << meta.name(*rec) << "\" with " << rec->argc << " args." << endl);
+                shared_ptr<ScmFunc> func = make_shared<ScmFunc>(rec->argc, sym->val);
+                func->facts = rec->facts;
+                func->noescape_args = rec->noescape;
+                obj = func;
+            }
+
+            if (obj) {
+                // Binding an existing name doesn't change the generation
+                binding[*sym] = obj;
+                return obj;
+            }
+        }
+        return nullptr;
+    }
+
     void ScmEnv::error(const string &msg) {
         cout << "Error: " << msg << endl;
         top_level_env->err_flag = err_flag = true;
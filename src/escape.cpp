@@ -0,0 +1,203 @@
+#include "../include/escape.hpp"
+#include "../include/debug.hpp"
+
+namespace llscm {
+    using namespace std;
+
+    static void collectListUses(P_ScmObj & expr_list, vector<RefUse> & uses, vector<ScmFunc*> & funcs) {
+        if (!expr_list || expr_list->t != T_CONS) {
+            return;
+        }
+        DPC<ScmCons>(expr_list)->each([&uses, &funcs](P_ScmObj & e) {
+            collectUses(e.get(), uses, funcs);
+        });
+    }
+
+    void collectUses(ScmObj * expr, vector<RefUse> & uses, vector<ScmFunc*> & funcs) {
+        if (!expr) {
+            return;
+        }
+
+        if (auto ref = dynamic_cast<ScmRef*>(expr)) {
+            uses.push_back({ ref, nullptr, 0 });
+        }
+        else if (auto func = dynamic_cast<ScmFunc*>(expr)) {
+            funcs.push_back(func);
+        }
+        else if (auto def = dynamic_cast<ScmDefineVarSyntax*>(expr)) {
+            collectUses(def->val.get(), uses, funcs);
+        }
+        else if (auto call = dynamic_cast<ScmCall*>(expr)) {
+            if (auto fn_ref = dynamic_cast<ScmRef*>(call->fexpr.get())) {
+                uses.push_back({ fn_ref, call, -1 });
+            }
+            else {
+                collectUses(call->fexpr.get(), uses, funcs);
+            }
+
+            int32_t idx = 0;
+            if (call->arg_list && call->arg_list->t == T_CONS) {
+                DPC<ScmCons>(call->arg_list)->each([&](P_ScmObj & e) {
+                    if (auto arg_ref = dynamic_cast<ScmRef*>(e.get())) {
+                        uses.push_back({ arg_ref, call, idx });
+                    }
+                    else {
+                        collectUses(e.get(), uses, funcs);
+                    }
+                    idx++;
+                });
+            }
+        }
+        else if (auto if_expr = dynamic_cast<ScmIfSyntax*>(expr)) {
+            collectUses(if_expr->cond_expr.get(), uses, funcs);
+            collectUses(if_expr->then_expr.get(), uses, funcs);
+            collectUses(if_expr->else_expr.get(), uses, funcs);
+        }
+        else if (auto let_expr = dynamic_cast<ScmLetSyntax*>(expr)) {
+            if (let_expr->bind_list->t == T_CONS) {
+                DPC<ScmCons>(let_expr->bind_list)->each([&uses, &funcs](P_ScmObj & e) {
+                    shared_ptr<ScmCons> kv = DPC<ScmCons>(e);
+                    collectUses(DPC<ScmCons>(kv->cdr)->car.get(), uses, funcs);
+                });
+            }
+            collectListUses(let_expr->body_list, uses, funcs);
+        }
+        else if (auto and_expr = dynamic_cast<ScmAndSyntax*>(expr)) {
+            collectListUses(and_expr->expr_list, uses, funcs);
+        }
+        else if (auto or_expr = dynamic_cast<ScmOrSyntax*>(expr)) {
+            collectListUses(or_expr->expr_list, uses, funcs);
+        }
+        else if (auto prog = dynamic_cast<ScmProg*>(expr)) {
+            for (auto & e: *prog) {
+                collectUses(e.get(), uses, funcs);
+            }
+        }
+    }
+
+    void EscapeInfo::addFunc(ScmFunc * func, vector<ScmFunc*> & worklist) {
+        if (!func->body_list || !func->arg_list || func->is_extern
+            || func->argc_expected == ArgsAnyCount || body_uses.count(func)) {
+            return;
+        }
+
+        vector<bool> & esc = param_escapes[func];
+        esc.assign((size_t)func->argc_expected, false);
+
+        if (func->arg_list->t == T_CONS) {
+            int32_t idx = 0;
+            DPC<ScmCons>(func->arg_list)->each([&](P_ScmObj & e) {
+                P_ScmObj arg = DPC<ScmRef>(e)->refObj();
+                params[arg.get()] = make_pair(func, idx);
+                // Captured parameters are stored to the heap storage
+                if (arg->location == T_HEAP_LOC) {
+                    esc[idx] = true;
+                }
+                idx++;
+            });
+        }
+
+        vector<RefUse> & uses = body_uses[func];
+        collectListUses(func->body_list, uses, worklist);
+    }
+
+    bool EscapeInfo::argEscapes(ScmCall * call, int32_t idx) {
+        if (call->indirect) {
+            return true;
+        }
+
+        ScmRef * fn_ref = DPC<ScmRef>(call->fexpr).get();
+        ScmFunc * callee = dynamic_cast<ScmFunc*>(fn_ref->refObj().get());
+        auto it = param_escapes.find(callee);
+        if (it == param_escapes.end() || idx >= (int32_t)it->second.size()) {
+            // Functions from other modules may have the flags in their metadata
+            return !(callee && idx < 32 && (callee->noescape_args >> idx) & 1);
+        }
+        return it->second[idx];
+    }
+
+    uint32_t EscapeInfo::noEscapeMask(ScmFunc * func) {
+        auto it = param_escapes.find(func);
+        if (it == param_escapes.end()) {
+            return 0;
+        }
+
+        uint32_t mask = 0;
+        for (size_t i = 0; i < it->second.size() && i < 32; i++) {
+            if (!it->second[i]) {
+                mask |= 1u << i;
+            }
+        }
+        return mask;
+    }
+
+    void EscapeInfo::analyze(ScmObj * prog) {
+        vector<RefUse> top_uses;
+        vector<ScmFunc*> worklist;
+
+        collectUses(prog, top_uses, worklist);
+        while (!worklist.empty()) {
+            ScmFunc * func = worklist.back();
+            worklist.pop_back();
+            addFunc(func, worklist);
+        }
+
+        // Parameters start as non-escaping. A parameter escapes when it is used
+        // in any other way than being called or passed to a non-escaping parameter.
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (auto & fu: body_uses) {
+                for (auto & u: fu.second) {
+                    auto p = params.find(u.ref->refObj().get());
+                    if (p == params.end() || p->second.first != fu.first) {
+                        continue;
+                    }
+
+                    int32_t idx = p->second.second;
+                    vector<bool> & esc = param_escapes[fu.first];
+                    if (esc[idx]) {
+                        continue;
+                    }
+                    if (!u.call || (u.arg_idx >= 0 && argEscapes(u.call, u.arg_idx))) {
+                        D(cerr << fu.first->name << ": parameter " << idx << " escapes" << endl);
+                        esc[idx] = true;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+
+    bool EscapeInfo::stackAllocClosures(ScmFunc * func) {
+        auto it = body_uses.find(func);
+        if (it == body_uses.end()) {
+            return false;
+        }
+
+        // Every use of the current heap storage has to be checked:
+        // closure objects of nested functions and their direct calls.
+        for (auto & u: it->second) {
+            ScmObj * robj = u.ref->refObj().get();
+            ScmFunc * fn = dynamic_cast<ScmFunc*>(robj);
+            if (!fn || !fn->has_closure || robj->location == T_HEAP_LOC) {
+                continue;
+            }
+
+            // Context pointer would be saved in the storage of the nested function
+            if (fn->passing_closure) {
+                return false;
+            }
+            // Stack frame of the caller is reused by the tail call
+            if (!u.call || u.call->tail_call) {
+                return false;
+            }
+            if (u.arg_idx >= 0 && argEscapes(u.call, u.arg_idx)) {
+                return false;
+            }
+        }
+
+        D(cerr << func->name << ": closure data allocated on the stack" << endl);
+        return true;
+    }
+}
@@ -0,0 +1,97 @@
+#include "../include/facts.hpp"
+#include "../include/escape.hpp"
+#include "../include/runtime/types.hpp"
+#include "../include/debug.hpp"
+
+namespace llscm {
+    using namespace std;
+
+    static const uint32_t RetFacts = FN_RET_BOOL | FN_RET_FIXNUM;
+
+    static ScmObj * lastExpr(P_ScmObj & expr_list) {
+        ScmObj * last = nullptr;
+        if (expr_list && expr_list->t == T_CONS) {
+            DPC<ScmCons>(expr_list)->each([&last](P_ScmObj & e) {
+                last = e.get();
+            });
+        }
+        return last;
+    }
+
+    // Return type hints of the expression value
+    static uint32_t exprRetFacts(ScmObj * expr) {
+        if (!expr) {
+            return 0;
+        }
+
+        if (expr->t == T_TRUE || expr->t == T_FALSE) {
+            return FN_RET_BOOL;
+        }
+        if (auto num = dynamic_cast<ScmInt*>(expr)) {
+            return num->val >= FIXNUM_MIN && num->val <= FIXNUM_MAX ? FN_RET_FIXNUM : 0;
+        }
+        if (auto call = dynamic_cast<ScmCall*>(expr)) {
+            ScmRef * fn_ref = dynamic_cast<ScmRef*>(call->fexpr.get());
+            ScmFunc * fn = fn_ref ? dynamic_cast<ScmFunc*>(fn_ref->refObj().get()) : nullptr;
+            return !call->indirect && fn ? fn->facts & RetFacts : 0;
+        }
+        if (auto if_expr = dynamic_cast<ScmIfSyntax*>(expr)) {
+            return exprRetFacts(if_expr->then_expr.get()) & exprRetFacts(if_expr->else_expr.get());
+        }
+        if (auto let_expr = dynamic_cast<ScmLetSyntax*>(expr)) {
+            return exprRetFacts(lastExpr(let_expr->body_list));
+        }
+        // The value of "and" is #f or the last value, "or" returns the first true value
+        if (auto and_expr = dynamic_cast<ScmAndSyntax*>(expr)) {
+            ScmObj * last = lastExpr(and_expr->expr_list);
+            return last ? exprRetFacts(last) & FN_RET_BOOL : FN_RET_BOOL;
+        }
+        if (auto or_expr = dynamic_cast<ScmOrSyntax*>(expr)) {
+            uint32_t res = FN_RET_BOOL;
+            if (or_expr->expr_list && or_expr->expr_list->t == T_CONS) {
+                DPC<ScmCons>(or_expr->expr_list)->each([&res](P_ScmObj & e) {
+                    res &= exprRetFacts(e.get());
+                });
+            }
+            return res;
+        }
+        return 0;
+    }
+
+    void computeFacts(ScmObj * prog) {
+        vector<RefUse> uses;
+        vector<ScmFunc*> worklist;
+        vector<ScmFunc*> funcs;
+
+        collectUses(prog, uses, worklist);
+        while (!worklist.empty()) {
+            ScmFunc * func = worklist.back();
+            worklist.pop_back();
+            if (!func->body_list || func->facts) {
+                continue;
+            }
+
+            func->facts = RetFacts;
+            funcs.push_back(func);
+            DPC<ScmCons>(func->body_list)->each([&uses, &worklist](P_ScmObj & e) {
+                collectUses(e.get(), uses, worklist);
+            });
+        }
+
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (ScmFunc * func: funcs) {
+                uint32_t facts = exprRetFacts(lastExpr(func->body_list)) & func->facts;
+                if (facts != func->facts) {
+                    func->facts = facts;
+                    changed = true;
+                }
+            }
+        }
+
+        for (ScmFunc * func: funcs) {
+            D(cerr << func->name << ": facts " << func->facts << endl);
+        }
+    }
+}
@@ -1,18 +1,195 @@
-#include <cinttypes>
+#include <cstring>
+#include <elf.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <llvm/ADT/STLExtras.h>
+#include <llvm/ADT/StringMap.h>
+#include <llvm/ADT/StringRef.h>
 #include "../include/lib_reader.hpp"
-#include "elfio/elfio.hpp"
 
 namespace llscm {
     using namespace std;
     using namespace llvm;
-    using namespace ELFIO;
 
     struct LibReader::Impl {
-        ELFIO::elfio reader;
-        ELFIO::section * dynsym;
+        const char * base = nullptr;
+        size_t length = 0;
+
+        const Elf64_Shdr * sections = nullptr;
+        uint32_t sec_num = 0;
+        const Elf64_Sym * dynsym = nullptr;
+        uint32_t sym_num = 0;
+        const char * dynstr = nullptr;
+        size_t dynstr_size = 0;
+        const uint32_t * gnu_hash = nullptr;
+        const uint32_t * sysv_hash = nullptr;
+        // Sizes of the hash sections in 32-bit words
+        uint64_t gnu_hash_words = 0;
+        uint64_t sysv_hash_words = 0;
+
+        // Used if the library has no hash section, built on the first lookup
+        StringMap<uint32_t> index;
+        bool indexed = false;
+
+        ~Impl() {
+            if (base) {
+                munmap((void*)base, length);
+            }
+        }
+
+        template<typename T>
+        const T * at(uint64_t offset, uint64_t size) const {
+            if (offset > length || size > length - offset) {
+                return nullptr;
+            }
+            return (const T*)(base + offset);
+        }
+
+        StringRef symName(uint32_t idx) const {
+            uint32_t name = dynsym[idx].st_name;
+            if (name >= dynstr_size) {
+                return StringRef();
+            }
+            // The string table may lack the terminating zero
+            return StringRef(dynstr + name, strnlen(dynstr + name, dynstr_size - name));
+        }
+
+        // The hash tables come from the file, a corrupt one is ignored
+        bool validGnuHash() const;
+        bool validSysvHash() const;
+
+        enum class Lookup {
+            FOUND, MISSING, INVALID
+        };
+
+        Lookup lookupGnuHash(StringRef name, uint32_t & res) const;
+        Lookup lookupSysvHash(StringRef name, uint32_t & res) const;
+        bool lookupIndex(StringRef name, uint32_t & res);
     };
 
+    static uint32_t gnuHash(StringRef name) {
+        uint32_t h = 5381;
+        for (unsigned char c: name) {
+            h = h * 33 + c;
+        }
+        return h;
+    }
+
+    static uint32_t sysvHash(StringRef name) {
+        uint32_t h = 0;
+        for (unsigned char c: name) {
+            h = (h << 4) + c;
+            uint32_t g = h & 0xf0000000;
+            if (g) {
+                h ^= g >> 24;
+            }
+            h &= ~g;
+        }
+        return h;
+    }
+
+    bool LibReader::Impl::validGnuHash() const {
+        uint64_t nbuckets = gnu_hash[0];
+        uint64_t symoffset = gnu_hash[1];
+        uint64_t bloom_size = gnu_hash[2];
+
+        if (!nbuckets || !bloom_size || symoffset > sym_num) {
+            return false;
+        }
+        // Header, bloom filter (64-bit words) and buckets,
+        // then one chain entry for every symbol from symoffset on
+        uint64_t chain_start = 4 + 2 * bloom_size + nbuckets;
+        return chain_start <= gnu_hash_words
+               && gnu_hash_words - chain_start >= sym_num - symoffset;
+    }
+
+    bool LibReader::Impl::validSysvHash() const {
+        uint64_t nbucket = sysv_hash[0];
+        uint64_t nchain = sysv_hash[1];
+
+        // There is a chain entry for every symbol
+        return nbucket && nchain >= sym_num && 2 + nbucket + nchain <= sysv_hash_words;
+    }
+
+    LibReader::Impl::Lookup LibReader::Impl::lookupGnuHash(StringRef name, uint32_t & res) const {
+        uint32_t nbuckets = gnu_hash[0];
+        uint32_t symoffset = gnu_hash[1];
+        uint32_t bloom_size = gnu_hash[2];
+        uint32_t bloom_shift = gnu_hash[3];
+        const uint64_t * bloom = (const uint64_t*)(gnu_hash + 4);
+        const uint32_t * buckets = (const uint32_t*)(bloom + bloom_size);
+        const uint32_t * chain = buckets + nbuckets;
+
+        uint32_t h = gnuHash(name);
+        // The bloom filter rejects most of the missing symbols
+        uint64_t word = bloom[(h / 64) % bloom_size];
+        uint64_t mask = (1ull << (h % 64)) | (1ull << ((h >> bloom_shift) % 64));
+        if ((word & mask) != mask) {
+            return Lookup::MISSING;
+        }
+
+        uint32_t idx = buckets[h % nbuckets];
+        if (idx == STN_UNDEF) {
+            return Lookup::MISSING;
+        }
+        if (idx < symoffset || idx >= sym_num) {
+            return Lookup::INVALID;
+        }
+
+        // Chain ends with the lowest bit set.
+        // validGnuHash checked that it fits in the section.
+        for (; idx < sym_num; idx++) {
+            uint32_t h2 = chain[idx - symoffset];
+            if ((h | 1) == (h2 | 1) && symName(idx) == name) {
+                res = idx;
+                return Lookup::FOUND;
+            }
+            if (h2 & 1) {
+                return Lookup::MISSING;
+            }
+        }
+        // Ran past the last symbol
+        return Lookup::INVALID;
+    }
+
+    LibReader::Impl::Lookup LibReader::Impl::lookupSysvHash(StringRef name, uint32_t & res) const {
+        uint32_t nbucket = sysv_hash[0];
+        const uint32_t * bucket = sysv_hash + 2;
+        const uint32_t * chain = bucket + nbucket;
+
+        // A longer chain must have a cycle
+        uint32_t steps = 0;
+        for (uint32_t idx = bucket[sysvHash(name) % nbucket];
+             idx != STN_UNDEF; idx = chain[idx]) {
+            if (idx >= sym_num || steps++ > sym_num) {
+                return Lookup::INVALID;
+            }
+            if (symName(idx) == name) {
+                res = idx;
+                return Lookup::FOUND;
+            }
+        }
+        return Lookup::MISSING;
+    }
+
+    bool LibReader::Impl::lookupIndex(StringRef name, uint32_t & res) {
+        if (!indexed) {
+            for (uint32_t i = 1; i < sym_num; i++) {
+                index.insert({ symName(i), i });
+            }
+            indexed = true;
+        }
+
+        auto it = index.find(name);
+        if (it == index.end()) {
+            return false;
+        }
+        res = it->second;
+        return true;
+    }
+
     LibReader::LibReader() {
         impl = make_unique<Impl>();
     }
@@ -20,51 +197,122 @@ namespace llscm {
     LibReader::~LibReader() {}
 
     bool LibReader::load(const string & libname) {
-        if (!impl->reader.load(libname)) {
+        impl = make_unique<Impl>();
+
+        int fd = open(libname.c_str(), O_RDONLY);
+        if (fd < 0) {
             return false;
         }
 
-        Elf_Half sec_num = impl->reader.sections.size();
+        struct stat st;
+        if (fstat(fd, &st) < 0 || st.st_size < (off_t)sizeof(Elf64_Ehdr)) {
+            close(fd);
+            return false;
+        }
 
-        for (uint32_t i = 0; i < sec_num; ++i) {
-            section * sec = impl->reader.sections[i];
+        // The mapping stays valid after closing the file
+        void * base = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            return false;
+        }
+        impl->base = (const char*)base;
+        impl->length = (size_t)st.st_size;
 
-            if (sec->get_type() == SHT_DYNSYM) {
-                impl->dynsym = sec;
-                break;
+        // Only the 64-bit libraries are produced by the compiler
+        const Elf64_Ehdr * hdr = (const Elf64_Ehdr*)base;
+        if (memcmp(hdr->e_ident, ELFMAG, SELFMAG) != 0 || hdr->e_ident[EI_CLASS] != ELFCLASS64
+            || hdr->e_shentsize != sizeof(Elf64_Shdr)) {
+            return false;
+        }
+
+        impl->sec_num = hdr->e_shnum;
+        impl->sections = impl->at<Elf64_Shdr>(hdr->e_shoff, (uint64_t)hdr->e_shnum * sizeof(Elf64_Shdr));
+        if (!impl->sections) {
+            return false;
+        }
+
+        for (uint32_t i = 0; i < impl->sec_num; ++i) {
+            const Elf64_Shdr & sec = impl->sections[i];
+
+            switch (sec.sh_type) {
+                case SHT_DYNSYM: {
+                    impl->dynsym = impl->at<Elf64_Sym>(sec.sh_offset, sec.sh_size);
+                    impl->sym_num = (uint32_t)(sec.sh_size / sizeof(Elf64_Sym));
+                    if (sec.sh_link < impl->sec_num) {
+                        const Elf64_Shdr & strtab = impl->sections[sec.sh_link];
+                        impl->dynstr = impl->at<char>(strtab.sh_offset, strtab.sh_size);
+                        impl->dynstr_size = impl->dynstr ? strtab.sh_size : 0;
+                    }
+                    break;
+                }
+                case SHT_GNU_HASH:
+                    if (sec.sh_size >= 4 * sizeof(uint32_t)) {
+                        impl->gnu_hash = impl->at<uint32_t>(sec.sh_offset, sec.sh_size);
+                        impl->gnu_hash_words = sec.sh_size / sizeof(uint32_t);
+                    }
+                    break;
+                case SHT_HASH:
+                    if (sec.sh_size >= 2 * sizeof(uint32_t)) {
+                        impl->sysv_hash = impl->at<uint32_t>(sec.sh_offset, sec.sh_size);
+                        impl->sysv_hash_words = sec.sh_size / sizeof(uint32_t);
+                    }
+                    break;
+                default:
+                    break;
             }
         }
 
-        return true;
+        // The symbols are then found by the linear scan
+        if (impl->gnu_hash && !impl->validGnuHash()) {
+            impl->gnu_hash = nullptr;
+        }
+        if (impl->sysv_hash && !impl->validSysvHash()) {
+            impl->sysv_hash = nullptr;
+        }
+
+        return impl->dynsym && impl->dynstr;
     }
 
-    void * LibReader::getAddressOfSymbol(const string & symname) {
-        const symbol_section_accessor symbols(impl->reader, impl->dynsym);
-
-        for (uint32_t j = 0; j < symbols.get_symbols_num(); ++j) {
-            string name;
-            Elf64_Addr value;
-            Elf_Xword size;
-            uint8_t bind;
-            uint8_t type;
-            Elf_Half section_index;
-            uint8_t other;
-
-            symbols.get_symbol(j, name, value, size, bind, type, section_index, other);
-
-            if (name == symname) {
-                section * data_sec = impl->reader.sections[section_index];
-                int64_t offset = value - data_sec->get_address();
-                const char * data = data_sec->get_data() + offset;
-                /*fprintf(stderr,
-                        "Symbol: name = %s, address = %" PRIx64 ", section_offset = %" PRIx64 ", data = %" PRIx8 "\n",
-                        name.c_str(), value, offset, *(uint8_t*)data
-                );*/
-
-                return (void*)data;
+    void * LibReader::getAddressOfSymbol(const string & symname, size_t * size) {
+        if (!impl->dynsym) {
+            return nullptr;
+        }
+
+        uint32_t idx;
+        Impl::Lookup res = Impl::Lookup::INVALID;
+        if (impl->gnu_hash) {
+            res = impl->lookupGnuHash(symname, idx);
+        }
+        else if (impl->sysv_hash) {
+            res = impl->lookupSysvHash(symname, idx);
+        }
+
+        if (res == Impl::Lookup::INVALID) {
+            // No hash table or a corrupt chain
+            if (!impl->lookupIndex(symname, idx)) {
+                return nullptr;
             }
         }
+        else if (res == Impl::Lookup::MISSING) {
+            return nullptr;
+        }
+
+        const Elf64_Sym & sym = impl->dynsym[idx];
+        if (sym.st_shndx == SHN_UNDEF || sym.st_shndx >= impl->sec_num) {
+            return nullptr;
+        }
+
+        // Translate the virtual address to the file offset
+        const Elf64_Shdr & data_sec = impl->sections[sym.st_shndx];
+        if (data_sec.sh_type == SHT_NOBITS) {
+            return nullptr;
+        }
+        const char * data = impl->at<char>(data_sec.sh_offset + (sym.st_value - data_sec.sh_addr), sym.st_size);
+        if (data && size) {
+            *size = (size_t)sym.st_size;
+        }
 
-        return nullptr;
+        return (void*)data;
     }
 }
@@ -1,97 +1,118 @@
-#include <new>
+#include <algorithm>
 #include <iostream>
 #include "../include/libmetainfo.hpp"
 #include "../include/debug.hpp"
 
 namespace llscm {
-    const size_t Metadata::InitSize = 1024;
     const char Metadata::magic[] = "\xFE\xEDLLSMETA";
+    const uint32_t Metadata::Version = 3;
 
-    Metadata::Metadata() {
-        metadata = (uint8_t*)malloc(InitSize * sizeof(uint8_t));
-        if (!metadata) {
-            cerr << "Allocation failed." << endl;
-            exit(EXIT_FAILURE);
-        }
-        alloc_size = InitSize;
-
-        size_t magiclen = strlen(magic);
-        memcpy(metadata, magic, magiclen);
+    bool Metadata::loadFromBlob(const void * data, size_t size) {
+        D(cerr << "METAINFO FOUND AT " << data << endl);
 
-        md_size = magiclen;
-    }
+        blob = (const uint8_t*)data;
+        hdr = (const MetaHeader*)blob;
 
-    Metadata::~Metadata() {
-        free(metadata);
-    }
+        if (size && size < sizeof(MetaHeader)) {
+            return false;
+        }
+        if (memcmp(hdr->magic, magic, strlen(magic)) || hdr->version != Version) {
+            hdr = nullptr;
+            return false;
+        }
 
-    FunctionInfo * Metadata::addRecord(int32_t argc, const string & name) {
-        size_t namelen = name.length();
-        uint8_t * arr;
-
-        if (alloc_size - md_size < FunctionInfo::size(namelen)) {
-            alloc_size *= 2;
-            arr = (uint8_t*)realloc(metadata, alloc_size * sizeof(uint8_t));
-            if (!arr) {
-                cerr << "Allocation failed." << endl;
-                exit(EXIT_FAILURE);
-            }
-            metadata = arr;
+        size_t funcs_off = sizeof(MetaHeader);
+        size_t globals_off = funcs_off + hdr->func_count * sizeof(FunctionInfo);
+        size_t strtab_off = globals_off + hdr->global_count * sizeof(GlobalInfo);
+        if (size && size < strtab_off + hdr->strtab_size) {
+            hdr = nullptr;
+            return false;
         }
-        FunctionInfo * rec = new(metadata + md_size, namelen) FunctionInfo(argc, name.c_str());
-        md_size += rec->size();
 
-        return rec;
+        funcs = (const FunctionInfo*)(blob + funcs_off);
+        globals = (const GlobalInfo*)(blob + globals_off);
+        strtab = (const char*)(blob + strtab_off);
+        return true;
     }
 
-    vector<uint8_t> Metadata::getBlob() {
-        addRecord(0, ""); // Empty record marks the end of array.
-        return vector<uint8_t>(metadata, metadata + md_size);
+    template<typename T>
+    static const T * findRecord(const T * begin, const T * end, const char * strtab, const char * name) {
+        auto it = lower_bound(begin, end, name, [strtab](const T & rec, const char * n) {
+            return strcmp(strtab + rec.name, n) < 0;
+        });
+        if (it == end || strcmp(strtab + it->name, name)) {
+            return nullptr;
+        }
+        return it;
     }
 
-    bool Metadata::loadFromBlob(void * blob) {
-        D(cerr << "METAINFO FOUND AT " << blob << endl);
-
-        size_t magiclen = strlen(magic);
-        uint8_t * arr_ptr = (uint8_t*)blob;
-
-        if (memcmp(arr_ptr, magic, magiclen)) {
-            return false;
+    const FunctionInfo * Metadata::findFunction(const char * fname) const {
+        if (!hdr) {
+            return nullptr;
         }
-        arr_ptr += magiclen;
-
-        FunctionInfo * rec;
-        FunctionInfo * saved;
-
-        do {
-            rec = (FunctionInfo*)arr_ptr;
-            saved = addRecord(rec->argc, rec->name);
-            arr_ptr += saved->size();
-        } while (rec->name[0]);
-
-        return true;
+        return findRecord(funcs, funcs + hdr->func_count, strtab, fname);
     }
 
-    void * FunctionInfo::operator new(std::size_t s, void * p, int32_t namelen) {
-        // Allocate enough space for variable length function name
-        std::size_t size = s;
-        size += namelen * sizeof(char);
+    const GlobalInfo * Metadata::findGlobal(const char * gname) const {
+        if (!hdr) {
+            return nullptr;
+        }
+        return findRecord(globals, globals + hdr->global_count, strtab, gname);
+    }
 
-        return ::operator new(size, p);
+    void MetadataBuilder::addFunction(const string & name, int32_t argc, uint32_t facts, uint32_t noescape) {
+        funcs.push_back({ name, { 0, argc, facts, noescape } });
     }
 
-    size_t FunctionInfo::size() {
-        return size(strlen(name));
+    void MetadataBuilder::addGlobal(const string & name) {
+        globals.push_back(name);
     }
 
-    size_t FunctionInfo::size(size_t namelen) {
-        size_t s = sizeof(FunctionInfo);
-        s += namelen * sizeof(char);
-        return s;
+    static void appendBytes(vector<uint8_t> & blob, const void * data, size_t size) {
+        const uint8_t * bytes = (const uint8_t*)data;
+        blob.insert(blob.end(), bytes, bytes + size);
     }
 
-    FunctionInfo::FunctionInfo(int32_t argc, const char * name) {
-        this->argc = argc;
-        strcpy(this->name, name);
+    vector<uint8_t> MetadataBuilder::getBlob() {
+        // Sorted by name for the binary search (a redefinition keeps the last record)
+        stable_sort(funcs.begin(), funcs.end(), [](const Record & a, const Record & b) {
+            return a.name < b.name;
+        });
+        auto last_func = [](const Record & a, const Record & b) { return a.name == b.name; };
+        reverse(funcs.begin(), funcs.end());
+        funcs.erase(unique(funcs.begin(), funcs.end(), last_func), funcs.end());
+        reverse(funcs.begin(), funcs.end());
+
+        sort(globals.begin(), globals.end());
+        globals.erase(unique(globals.begin(), globals.end()), globals.end());
+
+        string strtab;
+        vector<FunctionInfo> func_recs;
+        vector<GlobalInfo> global_recs;
+        for (auto & f: funcs) {
+            FunctionInfo rec = f.info;
+            rec.name = (uint32_t)strtab.size();
+            strtab.append(f.name.c_str(), f.name.size() + 1);
+            func_recs.push_back(rec);
+        }
+        for (auto & g: globals) {
+            global_recs.push_back({ (uint32_t)strtab.size(), 0 });
+            strtab.append(g.c_str(), g.size() + 1);
+        }
+
+        MetaHeader hdr;
+        memset(&hdr, 0, sizeof(hdr));
+        memcpy(hdr.magic, Metadata::magic, strlen(Metadata::magic));
+        hdr.version = Metadata::Version;
+        hdr.func_count = (uint32_t)func_recs.size();
+        hdr.global_count = (uint32_t)global_recs.size();
+        hdr.strtab_size = (uint32_t)strtab.size();
+
+        vector<uint8_t> blob;
+        appendBytes(blob, &hdr, sizeof(hdr));
+        appendBytes(blob, func_recs.data(), func_recs.size() * sizeof(FunctionInfo));
+        appendBytes(blob, global_recs.data(), global_recs.size() * sizeof(GlobalInfo));
+        appendBytes(blob, strtab.data(), strtab.size());
+        return blob;
     }
-}
\ No newline at end of file
+}
@@ -291,7 +291,7 @@ namespace llscm {
 			return &tok;
 		}
 
-		switch(obj->tag) {
+		switch(obj.tag()) {
 			case S_FALSE: {
 				tok.t = KWRD;
 				tok.name = "#f";
@@ -316,7 +316,7 @@ namespace llscm {
 			case S_INT: {
 				tok.t = INT;
 				tok.name = "";
-				tok.int_val = obj.asInt->value;
+				tok.int_val = obj.intValue();
 
 				return &tok;
 			}
@@ -0,0 +1,158 @@
+#include <cstdlib>
+#include <llvm/Bitcode/ReaderWriter.h>
+#include <llvm/ExecutionEngine/ExecutionEngine.h>
+#include <llvm/ExecutionEngine/Orc/CompileUtils.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Target/TargetMachine.h>
+#include "../../include/runtime/compile_service.hpp"
+#include "../../include/runtime/object_cache.hpp"
+#include "../../include/codegen.hpp"
+#include "../../include/debug.hpp"
+
+namespace llscm {
+    namespace runtime {
+        using namespace std;
+        using namespace llvm;
+
+        CompileService::CompileService(TargetOptions opts, unsigned opt_level):
+                options(opts), opt_level(opt_level),
+                local_tm(EngineBuilder().setTargetOptions(opts).selectTarget()), stopping(false) {
+            target = local_tm->getTargetTriple().str() + "/" + local_tm->getTargetCPU().str()
+                     + "/" + local_tm->getTargetFeatureString().str();
+        }
+
+        CompileService::~CompileService() {
+            {
+                lock_guard<mutex> guard(lock);
+                stopping = true;
+            }
+            cond.notify_all();
+            for (auto & w: workers) {
+                w.join();
+            }
+        }
+
+        unsigned CompileService::threadCount() {
+            static unsigned count = [] () {
+                const char * env = getenv("LLSCHEME_JIT_THREADS");
+                if (env) {
+                    return (unsigned)atoi(env);
+                }
+                return max(thread::hardware_concurrency(), 1u);
+            }();
+            return count;
+        }
+
+        // Null if the buffer isn't a valid object (it's compiled again then)
+        static shared_ptr<CompileService::Object> loadObject(unique_ptr<MemoryBuffer> buf) {
+            if (!buf) {
+                return nullptr;
+            }
+            auto obj = object::ObjectFile::createObjectFile(buf->getMemBufferRef());
+            if (!obj) {
+                return nullptr;
+            }
+            return make_shared<CompileService::Object>(move(*obj), move(buf));
+        }
+
+        // Names the module by its cache key, null if the object isn't cached
+        shared_ptr<CompileService::Object> CompileService::findCached(Module & mod, StringRef bitcode) {
+            DiskObjectCache * cache = DiskObjectCache::get();
+            if (!cache) {
+                return nullptr;
+            }
+            mod.setModuleIdentifier(DiskObjectCache::cacheKey(bitcode, target, opt_level));
+            return loadObject(cache->getObject(&mod));
+        }
+
+        CompileService::ObjectFuture CompileService::submit(Module & mod) {
+            unique_ptr<Job> job = make_unique<Job>();
+            ObjectFuture object = job->result.get_future().share();
+            if (threadCount() == 0) {
+                job->result.set_value(compile(mod));
+                return object;
+            }
+
+            raw_svector_ostream os(job->bitcode);
+            WriteBitcodeToFile(&mod, os);
+            if (shared_ptr<Object> cached = findCached(mod, StringRef(job->bitcode.data(), job->bitcode.size()))) {
+                job->result.set_value(cached);
+                return object;
+            }
+            job->name = mod.getModuleIdentifier();
+
+            {
+                lock_guard<mutex> guard(lock);
+                // Started by the first compilation
+                if (workers.empty()) {
+                    for (unsigned i = 0; i < threadCount(); i++) {
+                        workers.emplace_back(&CompileService::work, this);
+                    }
+                }
+                queue.push_back(move(job));
+            }
+            cond.notify_one();
+            return object;
+        }
+
+        void CompileService::work() {
+            // The target machine isn't shared between the threads
+            unique_ptr<TargetMachine> tm(EngineBuilder().setTargetOptions(options).selectTarget());
+
+            while (true) {
+                unique_ptr<Job> job;
+                {
+                    unique_lock<mutex> guard(lock);
+                    cond.wait(guard, [this] { return stopping || !queue.empty(); });
+                    if (stopping) {
+                        return;
+                    }
+                    job = move(queue.front());
+                    queue.pop_front();
+                }
+                job->result.set_value(compile(*job, *tm));
+            }
+        }
+
+        shared_ptr<CompileService::Object> CompileService::compile(Module & mod, bool use_cache) {
+            // The cache key is computed from the bitcode
+            if (use_cache && DiskObjectCache::get()) {
+                SmallVector<char, 0> bitcode;
+                raw_svector_ostream os(bitcode);
+                WriteBitcodeToFile(&mod, os);
+                if (shared_ptr<Object> cached = findCached(mod, StringRef(bitcode.data(), bitcode.size()))) {
+                    return cached;
+                }
+            }
+            // Not stored unless named by the cache key
+            return compileModule(mod, *local_tm);
+        }
+
+        shared_ptr<CompileService::Object> CompileService::compile(Job & job, TargetMachine & tm) {
+            // Everything created from the bitcode is freed with the context
+            LLVMContext ctx;
+            unique_ptr<MemoryBuffer> buf = MemoryBuffer::getMemBuffer(
+                    StringRef(job.bitcode.data(), job.bitcode.size()), "", false);
+            ErrorOr<unique_ptr<Module>> mod = parseBitcodeFile(buf->getMemBufferRef(), ctx);
+            if (!mod) {
+                D(cerr << "CompileService: invalid bitcode" << endl);
+                return nullptr;
+            }
+
+            (*mod)->setModuleIdentifier(job.name);
+            return compileModule(**mod, tm);
+        }
+
+        shared_ptr<CompileService::Object> CompileService::compileModule(Module & mod, TargetMachine & tm) {
+            ScmCodeGen::optimizeModule(mod, opt_level, &tm);
+            orc::SimpleCompiler compiler(tm);
+            shared_ptr<Object> object = make_shared<Object>(compiler(mod));
+
+            if (DiskObjectCache * cache = DiskObjectCache::get()) {
+                cache->notifyObjectCompiled(&mod, object->getBinary()->getMemoryBufferRef());
+            }
+            return object;
+        }
+    }
+}
@@ -7,9 +7,10 @@
 namespace llscm {
     namespace runtime {
         void error_not_a_function(scm_type_t * obj) {
+            scm_ptr_t ptr = obj;
             fprintf(stderr, "obj address: %p\n", obj);
-            fprintf(stderr, "obj tag: %d\n", obj->tag);
-            RUNTIME_ERROR("Cannot call object of type %s, expected %s.\n", TagName[obj->tag], TagName[S_FUNC]);
+            fprintf(stderr, "obj tag: %d\n", ptr.tag());
+            RUNTIME_ERROR("Cannot call object of type %s, expected %s.\n", TagName[ptr.tag()], TagName[S_FUNC]);
         }
 
         // TODO: Store function name in the scm_func object
@@ -0,0 +1,830 @@
+#include <cstdlib>
+#include <cstring>
+#include <gc_allocator.h>
+#include <llvm/IR/IRBuilder.h>
+#include "../../include/runtime/interp.hpp"
+#include "../../include/runtime/internal.hpp"
+#include "../../include/environment.hpp"
+#include "../../include/debug.hpp"
+
+namespace llscm {
+    namespace runtime {
+        using namespace std;
+        using namespace llvm;
+
+        struct Interpreter::Lambda {
+            ScmFunc * fn;
+            Program * prog;
+            uint32_t calls;
+            // Set when the function is compiled
+            FuncAddr compiled;
+        };
+
+        // Allocated by the GC: the contexts of the closures refer to the program,
+        // it's deleted together with the last closure (or when run returns).
+        struct Interpreter::Program: public gc_cleanup {
+            shared_ptr<ScmProg> ast;
+            P_ScmEnv env;
+            // Lexically enclosing function of each local function and lambda
+            unordered_map<ScmFunc*, ScmFunc*> parents;
+            unordered_map<ScmFunc*, unique_ptr<Lambda>> lambdas;
+            unordered_map<ScmObj*, scm_type_t**> cells;
+            unordered_map<ScmFunc*, FuncAddr> funcs;
+            // Quoted data are created once, like the constants of the compiled code.
+            // The nodes are allocated by the GC as well, so the data stay alive.
+            unordered_map<ScmObj*, scm_type_t*, hash<ScmObj*>, equal_to<ScmObj*>,
+                          gc_allocator<pair<ScmObj * const, scm_type_t*>>> quoted;
+        };
+
+        static bool isLambdaName(const string & name) {
+            return StringRef(name).startswith("__lambda#");
+        }
+
+        // Named global functions are always compiled (and called by name)
+        static bool isInterpreted(ScmFunc * fn) {
+            if (!fn->arg_list || !fn->body_list) {
+                return false;
+            }
+            return !(fn->location == T_GLOB && fn->is_extern && !isLambdaName(fn->name));
+        }
+
+        static ScmFunc * calledFunc(ScmCall * call) {
+            ScmRef * fn_ref = dynamic_cast<ScmRef*>(call->fexpr.get());
+            return fn_ref ? dynamic_cast<ScmFunc*>(fn_ref->refObj().get()) : nullptr;
+        }
+
+        // Frame layout
+        static scm_type_t ** parentFrame(scm_type_t ** frame) {
+            return (scm_type_t**)frame[0];
+        }
+
+        static ScmFunc * frameOwner(scm_type_t ** frame) {
+            return (ScmFunc*)frame[1];
+        }
+
+        static scm_type_t ** newFrame(scm_type_t ** parent, ScmFunc * owner, int32_t size) {
+            scm_type_t ** frame = alloc_heap_storage(3 + 2 * size);
+            frame[0] = (scm_type_t*)parent;
+            frame[1] = (scm_type_t*)owner;
+            frame[2] = (scm_type_t*)(intptr_t)size;
+            return frame;
+        }
+
+        static void bindValue(scm_type_t ** frame, int32_t idx, ScmObj * key, scm_type_t * val) {
+            frame[3 + 2 * idx] = (scm_type_t*)key;
+            frame[4 + 2 * idx] = val;
+        }
+
+        static scm_type_t ** findBinding(scm_type_t ** frame, ScmObj * key) {
+            for (; frame; frame = parentFrame(frame)) {
+                intptr_t size = (intptr_t)frame[2];
+                for (intptr_t i = 0; i < size; i++) {
+                    if ((ScmObj*)frame[3 + 2 * i] == key) {
+                        return &frame[4 + 2 * i];
+                    }
+                }
+            }
+            return nullptr;
+        }
+
+        // Frames of the function activation where the owner was defined
+        // (the chain doesn't grow with the recursive calls)
+        static scm_type_t ** enclosingFrame(scm_type_t ** frame, ScmFunc * owner) {
+            while (frame && frameOwner(frame) != owner) {
+                frame = parentFrame(frame);
+            }
+            return frame;
+        }
+
+        Interpreter::Interpreter(Compiler comp, Resolver res, Loader load):
+                compile(comp), resolve(res), load(load), have_entries(false) {}
+
+        Interpreter::~Interpreter() {}
+
+        bool Interpreter::enabled() {
+            static bool enabled = [] () {
+                const char * env = getenv("LLSCHEME_INTERP");
+                return !env || strcmp(env, "0") != 0;
+            }();
+            return enabled;
+        }
+
+        static bool quotedSupported(ScmObj * data) {
+            switch (data->t) {
+                case T_INT: case T_FLOAT: case T_STR: case T_SYM:
+                case T_TRUE: case T_FALSE: case T_NULL:
+                    return true;
+                case T_CONS: {
+                    ScmCons * cell = static_cast<ScmCons*>(data);
+                    return quotedSupported(cell->car.get()) && quotedSupported(cell->cdr.get());
+                }
+                default:
+                    return false;
+            }
+        }
+
+        static bool exprSupported(ScmObj * expr);
+
+        static bool listSupported(P_ScmObj & expr_list) {
+            if (!expr_list || expr_list->t != T_CONS) {
+                return true;
+            }
+            bool res = true;
+            DPC<ScmCons>(expr_list)->each([&res](P_ScmObj & e) {
+                res = res && exprSupported(e.get());
+            });
+            return res;
+        }
+
+        static bool exprSupported(ScmObj * expr) {
+            if (auto ref = dynamic_cast<ScmRef*>(expr)) {
+                ScmObj * robj = ref->refObj().get();
+                auto fn = dynamic_cast<ScmFunc*>(robj);
+                if (!robj || !fn) {
+                    return robj != nullptr;
+                }
+                if (isInterpreted(fn)) {
+                    // Passed around by the compiled entry points
+                    return fn->argc_expected != ArgsAnyCount && fn->argc_expected <= Interpreter::MaxArgs;
+                }
+                // Natives with fixed arguments would need a trampoline
+                return !fn->is_native || fn->argc_expected == ArgsAnyCount;
+            }
+            if (auto call = dynamic_cast<ScmCall*>(expr)) {
+                if (!call->indirect && !calledFunc(call)) {
+                    return false;
+                }
+                return (call->indirect ? exprSupported(call->fexpr.get()) : true)
+                       && listSupported(call->arg_list);
+            }
+            if (auto def = dynamic_cast<ScmDefineVarSyntax*>(expr)) {
+                if (auto fn = dynamic_cast<ScmFunc*>(def->val.get())) {
+                    if (!isLambdaName(fn->name) && fn->location == T_GLOB) {
+                        return false;
+                    }
+                    return listSupported(fn->body_list);
+                }
+                return def->val->t == T_REF || exprSupported(def->val.get());
+            }
+            if (auto if_expr = dynamic_cast<ScmIfSyntax*>(expr)) {
+                return exprSupported(if_expr->cond_expr.get()) && exprSupported(if_expr->then_expr.get())
+                       && exprSupported(if_expr->else_expr.get());
+            }
+            if (auto let_expr = dynamic_cast<ScmLetSyntax*>(expr)) {
+                bool res = true;
+                if (let_expr->bind_list->t == T_CONS) {
+                    DPC<ScmCons>(let_expr->bind_list)->each([&res](P_ScmObj & e) {
+                        shared_ptr<ScmCons> kv = DPC<ScmCons>(e);
+                        res = res && exprSupported(DPC<ScmCons>(kv->cdr)->car.get());
+                    });
+                }
+                return res && listSupported(let_expr->body_list);
+            }
+            if (auto and_expr = dynamic_cast<ScmAndSyntax*>(expr)) {
+                return listSupported(and_expr->expr_list);
+            }
+            if (auto or_expr = dynamic_cast<ScmOrSyntax*>(expr)) {
+                return listSupported(or_expr->expr_list);
+            }
+            if (auto quote = dynamic_cast<ScmQuoteSyntax*>(expr)) {
+                return quotedSupported(quote->data.get());
+            }
+
+            switch (expr->t) {
+                case T_INT: case T_FLOAT: case T_STR: case T_TRUE: case T_FALSE: case T_NULL:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        bool Interpreter::canInterpret(ScmProg & prog) {
+            for (auto & e: prog) {
+                if (!exprSupported(e.get())) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static void collectParents(ScmObj * expr, ScmFunc * owner, unordered_map<ScmFunc*, ScmFunc*> & parents);
+
+        static void collectParents(P_ScmObj & expr_list, ScmFunc * owner,
+                                   unordered_map<ScmFunc*, ScmFunc*> & parents) {
+            if (!expr_list || expr_list->t != T_CONS) {
+                return;
+            }
+            DPC<ScmCons>(expr_list)->each([owner, &parents](P_ScmObj & e) {
+                collectParents(e.get(), owner, parents);
+            });
+        }
+
+        static void collectParents(ScmObj * expr, ScmFunc * owner, unordered_map<ScmFunc*, ScmFunc*> & parents) {
+            if (auto ref = dynamic_cast<ScmRef*>(expr)) {
+                // Lambdas are defined at the beginning of the program,
+                // referenced where they were written
+                auto fn = dynamic_cast<ScmFunc*>(ref->refObj().get());
+                if (fn && isLambdaName(fn->name)) {
+                    parents[fn] = owner;
+                }
+            }
+            else if (auto call = dynamic_cast<ScmCall*>(expr)) {
+                collectParents(call->fexpr.get(), owner, parents);
+                collectParents(call->arg_list, owner, parents);
+            }
+            else if (auto def = dynamic_cast<ScmDefineVarSyntax*>(expr)) {
+                if (auto fn = dynamic_cast<ScmFunc*>(def->val.get())) {
+                    if (!isLambdaName(fn->name)) {
+                        parents[fn] = owner;
+                    }
+                    collectParents(fn->body_list, fn, parents);
+                }
+                else {
+                    collectParents(def->val.get(), owner, parents);
+                }
+            }
+            else if (auto if_expr = dynamic_cast<ScmIfSyntax*>(expr)) {
+                collectParents(if_expr->cond_expr.get(), owner, parents);
+                collectParents(if_expr->then_expr.get(), owner, parents);
+                collectParents(if_expr->else_expr.get(), owner, parents);
+            }
+            else if (auto let_expr = dynamic_cast<ScmLetSyntax*>(expr)) {
+                if (let_expr->bind_list->t == T_CONS) {
+                    DPC<ScmCons>(let_expr->bind_list)->each([owner, &parents](P_ScmObj & e) {
+                        shared_ptr<ScmCons> kv = DPC<ScmCons>(e);
+                        collectParents(DPC<ScmCons>(kv->cdr)->car.get(), owner, parents);
+                    });
+                }
+                collectParents(let_expr->body_list, owner, parents);
+            }
+            else if (auto and_expr = dynamic_cast<ScmAndSyntax*>(expr)) {
+                collectParents(and_expr->expr_list, owner, parents);
+            }
+            else if (auto or_expr = dynamic_cast<ScmOrSyntax*>(expr)) {
+                collectParents(or_expr->expr_list, owner, parents);
+            }
+        }
+
+        scm_type_t * Interpreter::run(shared_ptr<ScmProg> prog, P_ScmEnv env) {
+            Program * program = new Program();
+            program->ast = prog;
+            program->env = env;
+
+            for (auto & e: *prog) {
+                collectParents(e.get(), nullptr, program->parents);
+
+                // Compiled code (from a nested eval or a promoted closure)
+                // may refer to the globals before their definitions run
+                auto def = dynamic_cast<ScmDefineVarSyntax*>(e.get());
+                if (def && def->val->location == T_GLOB && def->val->t != T_FUNC && def->val->t != T_REF) {
+                    def->val->exported_name = DPC<ScmSym>(def->name)->val;
+                }
+            }
+            // The same as after compilation
+            env->setGlobalsAsExternal();
+
+            Frame frame = nullptr;
+            scm_type_t * ret = nullptr;
+            for (auto & e: *prog) {
+                if (auto def = dynamic_cast<ScmDefineVarSyntax*>(e.get())) {
+                    evalDefine(program, def, frame);
+                    ret = nullptr;
+                }
+                else {
+                    ret = eval(program, e.get(), frame);
+                }
+            }
+
+            // No closure refers to the program
+            if (program->lambdas.empty()) {
+                delete program;
+            }
+            return ret;
+        }
+
+        scm_type_t ** Interpreter::findGlobal(const string & name) {
+            auto it = globals.find(name);
+            return it != globals.end() ? it->second : nullptr;
+        }
+
+        void Interpreter::forgetGlobals(Module & mod) {
+            if (globals.empty()) {
+                return;
+            }
+            // The cells stay allocated, older code may still use them
+            for (GlobalVariable & gv: mod.globals()) {
+                if (gv.hasExternalLinkage() && !gv.isDeclaration()) {
+                    globals.erase(gv.getName().str());
+                }
+            }
+        }
+
+        scm_type_t ** Interpreter::globalCell(Program * prog, ScmObj * obj) {
+            auto it = prog->cells.find(obj);
+            if (it != prog->cells.end()) {
+                return it->second;
+            }
+
+            const string & name = obj->exported_name;
+            scm_type_t ** cell = name.empty() ? nullptr : findGlobal(name);
+            if (!cell && !name.empty()) {
+                cell = (scm_type_t**)resolve(name);
+            }
+            if (!cell) {
+                RUNTIME_ERROR("Global %s is not defined.\n", name.c_str());
+            }
+            prog->cells[obj] = cell;
+            return cell;
+        }
+
+        const Interpreter::FuncAddr & Interpreter::funcAddress(Program * prog, ScmFunc * fn) {
+            auto it = prog->funcs.find(fn);
+            if (it != prog->funcs.end()) {
+                return it->second;
+            }
+
+            FuncAddr addr;
+            addr.fnptr = (scm_fnptr_t)resolve(fn->name);
+            addr.wrfnptr = (al_wrapper_t)resolve("argl_" + fn->name);
+            if (!addr.fnptr || !addr.wrfnptr) {
+                RUNTIME_ERROR("Function %s is not defined.\n", fn->name.c_str());
+            }
+            return prog->funcs[fn] = addr;
+        }
+
+        static scm_type_t * interpApply(Interpreter * interp, scm_type_t ** args, int32_t argc) {
+            return interp->apply(args, argc);
+        }
+
+        void Interpreter::genEntries() {
+            // For each number of arguments: the fastcc entry point called by the compiled code
+            // and the argument list wrapper, both pass the arguments to interpApply.
+            LLVMContext & context = getGlobalContext();
+            shared_ptr<Module> mod = make_shared<Module>("__interp_entries", context);
+            IRBuilder<> builder(context);
+
+            Type * obj_type = builder.getInt8PtrTy();
+            Type * arglist_type = PointerType::get(obj_type, 0);
+            FunctionType * apply_type = FunctionType::get(
+                    obj_type, { obj_type, arglist_type, builder.getInt32Ty() }, false
+            );
+            // The JIT library is loaded locally, its symbols can't be resolved by name
+            llvm::Constant * apply_fn = ConstantExpr::getIntToPtr(
+                    builder.getInt64((uint64_t)&interpApply), PointerType::get(apply_type, 0)
+            );
+            llvm::Constant * self = ConstantExpr::getIntToPtr(builder.getInt64((uint64_t)this), obj_type);
+
+            for (int32_t argc = 0; argc <= MaxArgs; argc++) {
+                vector<Type*> arg_types((uint32_t)argc + 1, obj_type);
+                Function * entry = Function::Create(
+                        FunctionType::get(obj_type, arg_types, false),
+                        GlobalValue::ExternalLinkage,
+                        "__interp_entry_" + to_string(argc), mod.get()
+                );
+                entry->setCallingConv(CallingConv::Fast);
+                builder.SetInsertPoint(BasicBlock::Create(context, "entry", entry));
+
+                Value * args = builder.CreateAlloca(obj_type, builder.getInt32((uint32_t)argc + 1));
+                uint32_t i = 0;
+                for (Argument & arg: entry->args()) {
+                    builder.CreateStore(&arg, builder.CreateGEP(args, builder.getInt32(i++)));
+                }
+                builder.CreateRet(builder.CreateCall(apply_type, apply_fn, { self, args, builder.getInt32((uint32_t)argc) }));
+
+                Function * wrapper = Function::Create(
+                        FunctionType::get(obj_type, { arglist_type }, false),
+                        GlobalValue::ExternalLinkage,
+                        "__interp_argl_" + to_string(argc), mod.get()
+                );
+                builder.SetInsertPoint(BasicBlock::Create(context, "entry", wrapper));
+                Value * arg_list = &*wrapper->args().begin();
+                builder.CreateRet(builder.CreateCall(apply_type, apply_fn, { self, arg_list, builder.getInt32((uint32_t)argc) }));
+            }
+
+            load(mod);
+            for (int32_t argc = 0; argc <= MaxArgs; argc++) {
+                entry_fn[argc] = (scm_fnptr_t)resolve("__interp_entry_" + to_string(argc));
+                entry_wrfn[argc] = (al_wrapper_t)resolve("__interp_argl_" + to_string(argc));
+                assert(entry_fn[argc] && entry_wrfn[argc]);
+            }
+            have_entries = true;
+        }
+
+        Interpreter::Lambda * Interpreter::getLambda(Program * prog, ScmFunc * fn) {
+            unique_ptr<Lambda> & lambda = prog->lambdas[fn];
+            if (!lambda) {
+                lambda = make_unique<Lambda>();
+                lambda->fn = fn;
+                lambda->prog = prog;
+                lambda->calls = 0;
+                lambda->compiled = { nullptr, nullptr };
+            }
+            return lambda.get();
+        }
+
+        Interpreter::Lambda * Interpreter::asLambda(scm_func_t * func) {
+            if (!have_entries || func->argc < 0 || func->argc > MaxArgs
+                || func->fnptr != entry_fn[func->argc]) {
+                return nullptr;
+            }
+            // Context: captured frame, lambda, program
+            return (Lambda*)func->ctxptr[1];
+        }
+
+        scm_type_t * Interpreter::makeFunc(Program * prog, ScmFunc * fn, Frame env) {
+            if (!isInterpreted(fn)) {
+                const FuncAddr & addr = funcAddress(prog, fn);
+                return alloc_func(fn->argc_expected, addr.fnptr, addr.wrfnptr, nullptr);
+            }
+
+            Lambda * lambda = getLambda(prog, fn);
+            if (lambda->compiled.fnptr) {
+                return alloc_func(fn->argc_expected, lambda->compiled.fnptr, lambda->compiled.wrfnptr, nullptr);
+            }
+            if (!have_entries) {
+                genEntries();
+            }
+
+            auto pit = prog->parents.find(fn);
+            scm_type_t ** ctx = alloc_heap_storage(3);
+            ctx[0] = (scm_type_t*)enclosingFrame(env, pit != prog->parents.end() ? pit->second : nullptr);
+            ctx[1] = (scm_type_t*)lambda;
+            // Keeps the program and its namespace (needed by the promotion) alive
+            ctx[2] = (scm_type_t*)prog;
+            return alloc_func(fn->argc_expected, entry_fn[fn->argc_expected], entry_wrfn[fn->argc_expected], ctx);
+        }
+
+        bool Interpreter::isHot(Lambda * lambda) {
+            if (lambda->compiled.wrfnptr) {
+                return true;
+            }
+            // Closures need the interpreter frames
+            if (++lambda->calls % FuncJitThreshold == 0 && !lambda->fn->has_closure) {
+                return promote(lambda);
+            }
+            return false;
+        }
+
+        bool Interpreter::prepareCompile(ScmObj * node, unordered_set<ScmFunc*> & seen) {
+            // Resets the state of the previous code generation
+            // and checks that the compiled code can access all of the globals.
+            auto resetFunc = [this, &seen] (ScmFunc * fn) {
+                if (!seen.insert(fn).second) {
+                    return true;
+                }
+                fn->IR_val = nullptr;
+                fn->IR_wrapper_fn_ptr = nullptr;
+                fn->IR_heap_storage = nullptr;
+                fn->IR_context_ptr = nullptr;
+                fn->IR_loop_header = nullptr;
+                fn->IR_loop_args.clear();
+                fn->is_extern = false;
+
+                bool res = true;
+                DPC<ScmCons>(fn->body_list)->each([this, &seen, &res](P_ScmObj & e) {
+                    res = res && prepareCompile(e.get(), seen);
+                });
+                return res;
+            };
+            auto prepareList = [this, &seen] (P_ScmObj & expr_list) {
+                bool res = true;
+                if (expr_list && expr_list->t == T_CONS) {
+                    DPC<ScmCons>(expr_list)->each([this, &seen, &res](P_ScmObj & e) {
+                        res = res && prepareCompile(e.get(), seen);
+                    });
+                }
+                return res;
+            };
+
+            if (auto fn = dynamic_cast<ScmFunc*>(node)) {
+                return !isInterpreted(fn) || resetFunc(fn);
+            }
+            if (auto ref = dynamic_cast<ScmRef*>(node)) {
+                ScmObj * robj = ref->refObj().get();
+                if (robj->t == T_FUNC) {
+                    return prepareCompile(robj, seen);
+                }
+                if (robj->location == T_GLOB) {
+                    const string & name = robj->exported_name;
+                    return robj->is_extern && !name.empty() && (findGlobal(name) || resolve(name));
+                }
+                return true;
+            }
+            if (auto call = dynamic_cast<ScmCall*>(node)) {
+                return prepareCompile(call->fexpr.get(), seen) && prepareList(call->arg_list);
+            }
+            if (auto def = dynamic_cast<ScmDefineVarSyntax*>(node)) {
+                return prepareCompile(def->val.get(), seen);
+            }
+            if (auto if_expr = dynamic_cast<ScmIfSyntax*>(node)) {
+                return prepareCompile(if_expr->cond_expr.get(), seen) && prepareCompile(if_expr->then_expr.get(), seen)
+                       && prepareCompile(if_expr->else_expr.get(), seen);
+            }
+            if (auto let_expr = dynamic_cast<ScmLetSyntax*>(node)) {
+                bool res = true;
+                if (let_expr->bind_list->t == T_CONS) {
+                    DPC<ScmCons>(let_expr->bind_list)->each([this, &seen, &res](P_ScmObj & e) {
+                        shared_ptr<ScmCons> kv = DPC<ScmCons>(e);
+                        res = res && prepareCompile(DPC<ScmCons>(kv->cdr)->car.get(), seen);
+                    });
+                }
+                return res && prepareList(let_expr->body_list);
+            }
+            if (auto and_expr = dynamic_cast<ScmAndSyntax*>(node)) {
+                return prepareList(and_expr->expr_list);
+            }
+            if (auto or_expr = dynamic_cast<ScmOrSyntax*>(node)) {
+                return prepareList(or_expr->expr_list);
+            }
+            return true;
+        }
+
+        bool Interpreter::promote(Lambda * lambda) {
+            ScmFunc * fn = lambda->fn;
+            unordered_set<ScmFunc*> seen;
+            // Tried again after the next FuncJitThreshold calls
+            if (!prepareCompile(fn, seen)) {
+                D(cerr << "interp: " << fn->name << " can't be compiled yet" << endl);
+                return false;
+            }
+
+            D(cerr << "interp: compiling " << fn->name << endl);
+            // The program returns the function object
+            P_ScmObj pfn = fn->shared_from_this();
+            ScmProg prog;
+            prog.push_back(make_shared<ScmDefineVarSyntax>(make_shared<ScmSym>(fn->name), pfn));
+            prog.push_back(make_shared<ScmRef>(fn->name, pfn));
+
+            scm_ptr_t func = compile(prog, lambda->prog->env)();
+            lambda->compiled = { func.asFunc->fnptr, func.asFunc->wrfnptr };
+            return true;
+        }
+
+        scm_type_t * Interpreter::apply(scm_type_t ** args, int32_t argc) {
+            scm_type_t ** ctx = (scm_type_t**)args[argc];
+            Lambda * lambda = (Lambda*)ctx[1];
+
+            if (isHot(lambda)) {
+                // The context pointer is ignored by the compiled function
+                return lambda->compiled.wrfnptr(args);
+            }
+
+            ScmFunc * fn = lambda->fn;
+            Frame env = newFrame((Frame)ctx[0], fn, argc);
+            if (argc) {
+                int32_t i = 0;
+                DPC<ScmCons>(fn->arg_list)->each([&env, &i, args](P_ScmObj & e) {
+                    bindValue(env, i, DPC<ScmRef>(e)->refObj().get(), args[i]);
+                    i++;
+                });
+            }
+
+            ScmObj * last = evalBody(lambda->prog, fn->body_list, env);
+            return eval(lambda->prog, last, env);
+        }
+
+        static scm_type_t * makeQuoted(ScmObj * data) {
+            switch (data->t) {
+                case T_INT:
+                    return alloc_int(static_cast<ScmInt*>(data)->val);
+                case T_FLOAT:
+                    return alloc_float(static_cast<ScmFloat*>(data)->val);
+                case T_STR:
+                    return alloc_str(static_cast<ScmLit*>(data)->val.c_str());
+                case T_SYM:
+                    return alloc_sym(static_cast<ScmLit*>(data)->val.c_str());
+                case T_TRUE:
+                    return SCM_TRUE;
+                case T_FALSE:
+                    return SCM_FALSE;
+                case T_CONS: {
+                    ScmCons * cell = static_cast<ScmCons*>(data);
+                    scm_type_t * car = makeQuoted(cell->car.get());
+                    return alloc_cons(car, makeQuoted(cell->cdr.get()));
+                }
+                default:
+                    return SCM_NULL;
+            }
+        }
+
+        scm_type_t * Interpreter::evalRef(Program * prog, ScmRef * ref, Frame env) {
+            ScmObj * robj = ref->refObj().get();
+
+            if (robj->t == T_FUNC) {
+                return makeFunc(prog, static_cast<ScmFunc*>(robj), env);
+            }
+            // Top level let variables are global as well
+            if (scm_type_t ** slot = findBinding(env, robj)) {
+                return *slot;
+            }
+            if (robj->location == T_GLOB) {
+                return *globalCell(prog, robj);
+            }
+            RUNTIME_ERROR("%s is used before its definition.\n", ref->val.c_str());
+        }
+
+        void Interpreter::evalDefine(Program * prog, ScmDefineVarSyntax * def, Frame & env) {
+            // Functions are created by the references, aliases refer to the original object
+            if (def->val->t == T_FUNC || def->val->t == T_REF) {
+                return;
+            }
+
+            scm_type_t * val = eval(prog, def->val.get(), env);
+
+            if (def->val->location == T_GLOB) {
+                const string & name = DPC<ScmSym>(def->name)->val;
+                scm_type_t ** & cell = globals[name];
+                if (!cell) {
+                    cell = (scm_type_t**)GC_MALLOC_UNCOLLECTABLE(sizeof(scm_type_t*));
+                }
+                *cell = val;
+                def->val->exported_name = name;
+                prog->cells[def->val.get()] = cell;
+            }
+            else {
+                Frame frame = newFrame(env, env ? frameOwner(env) : nullptr, 1);
+                bindValue(frame, 0, def->val.get(), val);
+                env = frame;
+            }
+        }
+
+        ScmObj * Interpreter::evalBody(Program * prog, P_ScmObj & body, Frame & env) {
+            // Evaluates all but the last expression (which is in the tail position)
+            ScmCons * cell = static_cast<ScmCons*>(body.get());
+            while (cell->cdr->t == T_CONS) {
+                if (auto def = dynamic_cast<ScmDefineVarSyntax*>(cell->car.get())) {
+                    evalDefine(prog, def, env);
+                }
+                else {
+                    eval(prog, cell->car.get(), env);
+                }
+                cell = static_cast<ScmCons*>(cell->cdr.get());
+            }
+            return cell->car.get();
+        }
+
+        Interpreter::Frame Interpreter::evalArgs(Program * prog, ScmFunc * fn, P_ScmObj & arg_list,
+                                                 Frame env, Frame parent) {
+            Frame frame = newFrame(parent, fn, fn->argc_expected);
+            if (fn->argc_expected == 0) {
+                return frame;
+            }
+
+            ScmCons * formal = static_cast<ScmCons*>(fn->arg_list.get());
+            int32_t i = 0;
+            DPC<ScmCons>(arg_list)->each([this, prog, env, frame, &formal, &i](P_ScmObj & e) {
+                ScmObj * key = DPC<ScmRef>(formal->car)->refObj().get();
+                bindValue(frame, i++, key, eval(prog, e.get(), env));
+                formal = static_cast<ScmCons*>(formal->cdr.get());
+            });
+            return frame;
+        }
+
+        static scm_type_t ** allocArgs(int32_t argc) {
+            // Zeroed: the context pointer and the end of the variable argument list
+            return alloc_heap_storage(argc + 2);
+        }
+
+        scm_type_t * Interpreter::eval(Program * prog, ScmObj * node, Frame env) {
+            // Calls and the last expressions of the bodies
+            // continue in the loop, so the tail calls don't grow the stack.
+            while (true) {
+                switch (node->t) {
+                    case T_INT:
+                        return alloc_int(static_cast<ScmInt*>(node)->val);
+                    case T_FLOAT:
+                        return alloc_float(static_cast<ScmFloat*>(node)->val);
+                    case T_STR:
+                        return alloc_str(static_cast<ScmLit*>(node)->val.c_str());
+                    case T_TRUE:
+                        return SCM_TRUE;
+                    case T_FALSE:
+                        return SCM_FALSE;
+                    case T_NULL:
+                        return SCM_NULL;
+                    case T_REF:
+                        return evalRef(prog, static_cast<ScmRef*>(node), env);
+                    case T_DEF:
+                        evalDefine(prog, static_cast<ScmDefineVarSyntax*>(node), env);
+                        return nullptr;
+                    case T_CALL: {
+                        ScmCall * call = static_cast<ScmCall*>(node);
+                        int32_t argc = call->argc;
+
+                        if (!call->indirect) {
+                            ScmFunc * fn = calledFunc(call);
+                            if (isInterpreted(fn)) {
+                                auto pit = prog->parents.find(fn);
+                                Frame parent = enclosingFrame(env, pit != prog->parents.end() ? pit->second : nullptr);
+                                env = evalArgs(prog, fn, call->arg_list, env, parent);
+                                node = evalBody(prog, fn->body_list, env);
+                                continue;
+                            }
+
+                            scm_type_t ** args = allocArgs(argc);
+                            int32_t i = 0;
+                            if (argc) {
+                                DPC<ScmCons>(call->arg_list)->each([this, prog, env, args, &i](P_ScmObj & e) {
+                                    args[i++] = eval(prog, e.get(), env);
+                                });
+                            }
+                            return funcAddress(prog, fn).wrfnptr(args);
+                        }
+
+                        scm_ptr_t func = eval(prog, call->fexpr.get(), env);
+                        if (func.tag() != S_FUNC) {
+                            error_not_a_function(func);
+                        }
+                        if (func.asFunc->argc != argc && func.asFunc->argc != ArgsAnyCount) {
+                            error_wrong_arg_num(func.asFunc, argc);
+                        }
+
+                        Lambda * lambda = asLambda(func.asFunc);
+                        if (lambda && !isHot(lambda)) {
+                            env = evalArgs(prog, lambda->fn, call->arg_list, env, (Frame)func.asFunc->ctxptr[0]);
+                            prog = lambda->prog;
+                            node = evalBody(prog, lambda->fn->body_list, env);
+                            continue;
+                        }
+
+                        scm_type_t ** args = allocArgs(argc);
+                        int32_t i = 0;
+                        if (argc) {
+                            DPC<ScmCons>(call->arg_list)->each([this, prog, env, args, &i](P_ScmObj & e) {
+                                args[i++] = eval(prog, e.get(), env);
+                            });
+                        }
+                        if (lambda) {
+                            return lambda->compiled.wrfnptr(args);
+                        }
+                        args[argc] = (scm_type_t*)func.asFunc->ctxptr;
+                        return func.asFunc->wrfnptr(args);
+                    }
+                    case T_EXPR: {
+                        if (auto if_expr = dynamic_cast<ScmIfSyntax*>(node)) {
+                            scm_ptr_t cond = eval(prog, if_expr->cond_expr.get(), env);
+                            node = cond.tag() != S_FALSE ? if_expr->then_expr.get() : if_expr->else_expr.get();
+                            continue;
+                        }
+                        if (auto let_expr = dynamic_cast<ScmLetSyntax*>(node)) {
+                            Frame frame;
+                            if (let_expr->bind_list->t == T_CONS) {
+                                ScmCons * bind_list = static_cast<ScmCons*>(let_expr->bind_list.get());
+                                frame = newFrame(env, env ? frameOwner(env) : nullptr, bind_list->length());
+                                int32_t i = 0;
+                                // The values are evaluated in the outer environment
+                                bind_list->each([this, prog, env, frame, &i](P_ScmObj & e) {
+                                    P_ScmObj & expr = DPC<ScmCons>(DPC<ScmCons>(e)->cdr)->car;
+                                    bindValue(frame, i++, expr.get(), eval(prog, expr.get(), env));
+                                });
+                                env = frame;
+                            }
+                            node = evalBody(prog, let_expr->body_list, env);
+                            continue;
+                        }
+                        if (auto and_expr = dynamic_cast<ScmAndSyntax*>(node)) {
+                            if (and_expr->expr_list->t != T_CONS) {
+                                return SCM_TRUE;
+                            }
+                            ScmCons * cell = static_cast<ScmCons*>(and_expr->expr_list.get());
+                            for (; cell->cdr->t == T_CONS; cell = static_cast<ScmCons*>(cell->cdr.get())) {
+                                scm_ptr_t val = eval(prog, cell->car.get(), env);
+                                if (val.tag() == S_FALSE) {
+                                    return val;
+                                }
+                            }
+                            node = cell->car.get();
+                            continue;
+                        }
+                        if (auto or_expr = dynamic_cast<ScmOrSyntax*>(node)) {
+                            if (or_expr->expr_list->t != T_CONS) {
+                                return SCM_FALSE;
+                            }
+                            ScmCons * cell = static_cast<ScmCons*>(or_expr->expr_list.get());
+                            for (; cell->cdr->t == T_CONS; cell = static_cast<ScmCons*>(cell->cdr.get())) {
+                                scm_ptr_t val = eval(prog, cell->car.get(), env);
+                                if (val.tag() != S_FALSE) {
+                                    return val;
+                                }
+                            }
+                            node = cell->car.get();
+                            continue;
+                        }
+                        if (auto quote = dynamic_cast<ScmQuoteSyntax*>(node)) {
+                            scm_type_t * & datum = prog->quoted[quote];
+                            if (!datum) {
+                                datum = makeQuoted(quote->data.get());
+                            }
+                            return datum;
+                        }
+                        break;
+                    }
+                    default:
+                        break;
+                }
+                // Rejected by canInterpret
+                RUNTIME_ERROR("%s: Unexpected expression.\n", __func__);
+            }
+        }
+    }
+}
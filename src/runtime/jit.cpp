@@ -0,0 +1,752 @@
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <string>
+#include <unordered_map>
+#include <iostream>
+#include <llvm/ADT/STLExtras.h>
+#include <fs_helpers.hpp>
+#include "../../include/runtime/jit.h"
+#include "../../include/runtime/internal.hpp"
+#include "../../include/runtime/scmjit.hpp"
+#include "../../include/runtime/interp.hpp"
+#include "../../include/runtime/compile_service.hpp"
+#include "../../include/runtime/readlinestream.hpp"
+#include "../../include/reader.hpp"
+#include "../../include/parser.hpp"
+#include "../../include/environment.hpp"
+#include "../../include/codegen.hpp"
+
+namespace llscm {
+    namespace runtime {
+        using namespace llvm;
+        using namespace orc;
+
+        class InitJIT {
+            unique_ptr<ScmJIT> jit;
+        public:
+            static bool started;
+
+            InitJIT();
+            ScmJIT * getJIT();
+        };
+
+        bool InitJIT::started = false;
+
+        static Interpreter & getInterpreter();
+
+        static unsigned getJITOptLevel() {
+            // LLSCHEME_JIT_OPT=<0-3> trades the eval latency for code quality
+            static unsigned level = [] () {
+                const char * env = getenv("LLSCHEME_JIT_OPT");
+                return env ? (unsigned)atoi(env) : 1u;
+            }();
+            return level;
+        }
+
+        static bool isJITLazy() {
+            // LLSCHEME_JIT_LAZY=1 compiles each function on its first call
+            static bool lazy = [] () {
+                const char * env = getenv("LLSCHEME_JIT_LAZY");
+                return env && atoi(env) != 0;
+            }();
+            return lazy;
+        }
+
+        InitJIT::InitJIT() {
+            started = true;
+            InitializeNativeTarget();
+            InitializeNativeTargetAsmPrinter();
+            InitializeNativeTargetAsmParser();
+            jit = make_unique<ScmJIT>(isJITLazy());
+            // The lazy modules are optimized function by function
+            ScmJIT * jit_ptr = jit.get();
+            jit->setPartitionOptimizer([jit_ptr] (Module & mod) {
+                ScmCodeGen::optimizeModule(mod, getJITOptLevel(), &jit_ptr->getTargetMachine());
+            });
+            // Symbols referenced by eval'd code resolve to the interned objects
+            jit->setSymbolHook([] (const string & name) -> uint64_t {
+                size_t prefix_len = strlen(SCM_SYM_PREFIX);
+                if (name.compare(0, prefix_len, SCM_SYM_PREFIX) == 0) {
+                    return (uint64_t)alloc_pinned_sym(name.c_str() + prefix_len);
+                }
+                // Globals defined by the interpreted code
+                return (uint64_t)getInterpreter().findGlobal(name);
+            });
+            D(std::cerr << "InitJIT completed" << std::endl);
+        }
+
+        ScmJIT * InitJIT::getJIT() {
+            return jit.get();
+        }
+
+        static string getUniqID(const string & name) {
+            static ScmNameGen gen;
+            return gen.getUniqID(name);
+        }
+
+        static ScmJIT * getJIT() {
+            static InitJIT jit_obj;
+            return jit_obj.getJIT();
+        }
+
+        static readlinestream & getReadlineStream() {
+            static readlinestream readlns;
+            return readlns;
+        }
+
+        // Appends a structural key of the quoted expression.
+        // Returns false for objects which can't be written in the source.
+        static bool appendExprKey(scm_ptr_t expr, string & key) {
+            while (true) {
+                switch (expr.tag()) {
+                    case S_NIL: key += 'n'; return true;
+                    case S_TRUE: key += 't'; return true;
+                    case S_FALSE: key += 'f'; return true;
+                    case S_INT: {
+                        int64_t val = expr.intValue();
+                        key += 'i';
+                        key.append((const char*)&val, sizeof(val));
+                        return true;
+                    }
+                    case S_FLOAT:
+                        key += 'd';
+                        key.append((const char*)&expr.asFloat->value, sizeof(double));
+                        return true;
+                    case S_STR:
+                        key += 's';
+                        key.append((const char*)&expr.asStr->len, sizeof(int32_t));
+                        key.append(expr.asStr->str, (size_t)expr.asStr->len);
+                        return true;
+                    case S_SYM:
+                        key += 'y';
+                        key.append((const char*)&expr.asSym->len, sizeof(int32_t));
+                        key.append(expr.asSym->sym, (size_t)expr.asSym->len);
+                        return true;
+                    case S_CONS:
+                        // Iterate over the list, recurse into the elements
+                        key += 'c';
+                        if (!appendExprKey(expr.asCons->car, key)) {
+                            return false;
+                        }
+                        expr = expr.asCons->cdr;
+                        break;
+                    default:
+                        return false;
+                }
+            }
+        }
+
+        // Modules of the expressions which neither define anything nor returned
+        // anything living in the module are removed from the JIT. The removal waits
+        // until no eval is running, the code may still be on the stack otherwise.
+        class ModuleReaper {
+            vector<ScmJIT::ModuleHandleT> pending;
+            uint32_t depth = 0;
+        public:
+            void enter() {
+                depth++;
+            }
+
+            void leave() {
+                if (--depth == 0 && !pending.empty()) {
+                    ScmJIT * jit = getJIT();
+                    for (auto & h: pending) {
+                        jit->removeModule(h);
+                    }
+                    pending.clear();
+                }
+            }
+
+            void retire(const ScmJIT::ModuleHandleT & h) {
+                pending.push_back(h);
+            }
+
+            // The module got referenced by the result of a nested eval
+            void keep(const ScmJIT::ModuleHandleT & h) {
+                auto it = find(pending.begin(), pending.end(), h);
+                if (it != pending.end()) {
+                    pending.erase(it);
+                }
+            }
+        };
+
+        static ModuleReaper & getReaper() {
+            static ModuleReaper reaper;
+            return reaper;
+        }
+
+        class EvalScope {
+        public:
+            EvalScope() {
+                getReaper().enter();
+            }
+
+            ~EvalScope() {
+                getReaper().leave();
+            }
+        };
+
+        struct CompiledExpr {
+            scm_expr_ptr_t func;
+            ScmJIT::ModuleHandleT handle;
+            // Null if the module must be kept
+            shared_ptr<const ScmJIT::SectionRangesT> sections;
+        };
+
+        static bool inSections(const void * ptr, const ScmJIT::SectionRangesT & sections) {
+            uint64_t addr = (uint64_t)ptr;
+            for (auto & r: sections) {
+                if (addr >= r.first && addr < r.second) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Replaces the constants of a module referenced from *slot with their copies.
+        // Returns false if the value has to keep the module (code, closures, large values).
+        static bool detachValue(scm_type_t ** slot, const ScmJIT::SectionRangesT & sections, uint32_t & budget) {
+            while (true) {
+                scm_ptr_t val = *slot;
+                if (!val.asType || is_fixnum(val.asType)) {
+                    return true;
+                }
+                if (budget-- == 0) {
+                    return false;
+                }
+                bool resident = inSections(val.asType, sections);
+                switch (val.tag()) {
+                    case S_TRUE:
+                        if (resident) *slot = SCM_TRUE;
+                        return true;
+                    case S_FALSE:
+                        if (resident) *slot = SCM_FALSE;
+                        return true;
+                    case S_NIL:
+                        if (resident) *slot = SCM_NULL;
+                        return true;
+                    case S_INT:
+                        if (resident) *slot = alloc_int(val.asInt->value);
+                        return true;
+                    case S_FLOAT:
+                        if (resident) *slot = alloc_float(val.asFloat->value);
+                        return true;
+                    case S_STR:
+                        if (resident) *slot = alloc_str(val.asStr->str);
+                        return true;
+                    case S_CONS:
+                        // Constant lists are read-only, only the copies get written
+                        if (resident) {
+                            val = alloc_cons(val.asCons->car, val.asCons->cdr);
+                            *slot = val;
+                        }
+                        if (!detachValue(&val.asCons->car, sections, budget)) {
+                            return false;
+                        }
+                        slot = &val.asCons->cdr;
+                        break;
+                    case S_VEC:
+                        if (resident) {
+                            return false;
+                        }
+                        for (int32_t i = 0; i < val.asVec->size; i++) {
+                            if (!detachValue(&val.asVec->elems[i], sections, budget)) {
+                                return false;
+                            }
+                        }
+                        return true;
+                    case S_FUNC:
+                        // The context of a closure can't be inspected
+                        return !resident && !val.asFunc->ctxptr
+                               && !inSections((void*)val.asFunc->fnptr, sections)
+                               && !inSections((void*)val.asFunc->wrfnptr, sections);
+                    default:
+                        return !resident;
+                }
+            }
+        }
+
+        // Returns false if the module has to be kept because of the result
+        static bool detachResult(scm_type_t *& result, const CompiledExpr & expr) {
+            static const uint32_t MaxVisited = 100000;
+            if (!expr.sections) {
+                return false;
+            }
+            uint32_t budget = MaxVisited;
+            return detachValue(&result, *expr.sections, budget);
+        }
+
+        // Compiled expressions by the generation of the namespace and the expression structure.
+        // The generation is unique among all namespaces, so it identifies the namespace too.
+        class EvalCache {
+            // A full cache is simply cleared, the modules which can be removed are retired
+            static const size_t MaxEntries = 4096;
+            unordered_map<string, CompiledExpr> entries;
+            // Evaluations of the interpreted expressions
+            unordered_map<string, uint32_t> counts;
+        public:
+            static bool makeKey(scm_ptr_t expr, uint64_t generation, string & key) {
+                key.assign((const char*)&generation, sizeof(generation));
+                return appendExprKey(expr, key);
+            }
+
+            CompiledExpr * find(const string & key) {
+                auto it = entries.find(key);
+                return it != entries.end() ? &it->second : nullptr;
+            }
+
+            void add(const string & key, const CompiledExpr & expr) {
+                if (entries.size() >= MaxEntries) {
+                    for (auto & e: entries) {
+                        if (e.second.sections) {
+                            getReaper().retire(e.second.handle);
+                        }
+                    }
+                    entries.clear();
+                }
+                entries[key] = expr;
+            }
+
+            // The expression returned something living in its module
+            void keep(const string & key, const CompiledExpr & expr) {
+                CompiledExpr * e = find(key);
+                if (e && e->handle == expr.handle) {
+                    e->sections = nullptr;
+                }
+                // Retired by a nested eval
+                getReaper().keep(expr.handle);
+            }
+
+            // Returns the number of the previous evaluations
+            uint32_t countEval(const string & key) {
+                if (counts.size() >= MaxEntries) {
+                    counts.clear();
+                }
+                return counts[key]++;
+            }
+        };
+
+        static EvalCache & getEvalCache() {
+            static EvalCache cache;
+            return cache;
+        }
+
+        // Parses the quoted expression and resolves it in the namespace (null on error)
+        static shared_ptr<ScmProg> parseExpression(scm_type_t * expr, P_ScmEnv env) {
+            unique_ptr<Reader> r = make_unique<ListReader>(expr);
+            unique_ptr<Parser> p = make_unique<Parser>(r);
+
+            // Kept by the interpreted closures the expression creates
+            shared_ptr<ScmProg> prog = make_shared<ScmProg>(p->NT_Prog());
+
+            if (p->fail()) {
+                return nullptr;
+            }
+
+            env->setProg(*prog);
+
+            if (!prog->CT_Eval(env)) {
+                return nullptr;
+            }
+
+            /*for (auto & e: *prog) {
+                e->printSrc(cerr);
+                cerr << endl;
+            }*/
+            return prog;
+        }
+
+        // Generates the module with the expression function, not optimized yet
+        static shared_ptr<Module> genExpression(ScmProg & prog, P_ScmEnv env, const string & expr_name) {
+            ScmCodeGen cg(getGlobalContext(), &prog);
+            cg.makeExpression(expr_name);
+            cg.setOptLevel(getJITOptLevel());
+            cg.run();
+
+            shared_ptr<Module> mod = cg.getModule();
+            mod->setDataLayout(getJIT()->getTargetMachine().createDataLayout());
+            getInterpreter().forgetGlobals(*mod);
+
+            // Prepare the environment for any future compilation
+            env->setGlobalsAsExternal();
+            return mod;
+        }
+
+        static CompileService & getCompileService() {
+            static CompileService service(ScmJIT::getTargetOptions(), getJITOptLevel());
+            return service;
+        }
+
+        static scm_expr_ptr_t compileExpression(ScmProg & prog, P_ScmEnv env,
+                                                ScmJIT::ModuleHandleT * handle = nullptr,
+                                                bool use_cache = true) {
+            string expr_name = getUniqID("__anon_expr#");
+            shared_ptr<Module> mod = genExpression(prog, env, expr_name);
+
+            // Compile the Module
+            ScmJIT * jit = getJIT();
+            ScmJIT::ModuleHandleT h;
+            if (jit->isLazy()) {
+                h = jit->addModule(mod);
+            }
+            else {
+                // Loaded from the disk cache if this code was compiled before
+                shared_ptr<CompileService::Object> object = getCompileService().compile(*mod, use_cache);
+                D(mod->dump());
+                h = jit->addObject(move(object));
+            }
+            if (handle) {
+                *handle = h;
+            }
+            JITSymbol expr_func_symbol = jit->findSymbol(expr_name);
+            assert(expr_func_symbol);
+
+            return (scm_expr_ptr_t)expr_func_symbol.getAddress();
+        }
+
+        // The lazy JIT compiles the modules itself
+        static bool compilesInBackground() {
+            return CompileService::threadCount() > 0 && !getJIT()->isLazy();
+        }
+
+        // Hot expressions compiled in the background, installed by the following evals
+        struct PendingExpr {
+            string name;
+            CompileService::ObjectFuture object;
+        };
+
+        static unordered_map<string, PendingExpr> & getPendingExprs() {
+            static unordered_map<string, PendingExpr> pending;
+            return pending;
+        }
+
+        static scm_expr_ptr_t installObject(shared_ptr<CompileService::Object> object, const string & expr_name,
+                                            ScmJIT::ModuleHandleT & handle) {
+            ScmJIT * jit = getJIT();
+            handle = jit->addObject(move(object));
+            JITSymbol expr_func_symbol = jit->findSymbol(expr_name);
+            assert(expr_func_symbol);
+
+            return (scm_expr_ptr_t)expr_func_symbol.getAddress();
+        }
+
+        static void installCompiled() {
+            auto & pending = getPendingExprs();
+            for (auto it = pending.begin(); it != pending.end(); ) {
+                if (!CompileService::isReady(it->second.object)) {
+                    ++it;
+                    continue;
+                }
+                // Dropped if the compilation failed, the expression stays interpreted
+                if (shared_ptr<CompileService::Object> object = it->second.object.get()) {
+                    CompiledExpr compiled;
+                    compiled.func = installObject(move(object), it->second.name, compiled.handle);
+                    // Only the expressions without definitions are compiled in the background
+                    compiled.sections = getJIT()->getSections(compiled.handle);
+                    getEvalCache().add(it->first, compiled);
+                }
+                it = pending.erase(it);
+            }
+        }
+
+        static void compileInBackground(const string & key, ScmProg & prog, P_ScmEnv env) {
+            static const size_t MaxPending = 64;
+            auto & pending = getPendingExprs();
+            if (pending.size() >= MaxPending || pending.count(key)) {
+                return;
+            }
+
+            string expr_name = getUniqID("__anon_expr#");
+            // A nested eval may have changed it
+            env->setProg(prog);
+            shared_ptr<Module> mod = genExpression(prog, env, expr_name);
+            pending[key] = PendingExpr{expr_name, getCompileService().submit(*mod)};
+        }
+
+        // Lambdas are defined as globals too
+        static bool definesGlobals(ScmProg & prog) {
+            for (auto & e: prog) {
+                if (dynamic_cast<ScmDefineVarSyntax*>(e.get())) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        static void * findSymbolAddress(const string & name) {
+            // Nothing is compiled before the JIT starts
+            if (!InitJIT::started) {
+                return dlsym(RTLD_DEFAULT, name.c_str());
+            }
+            return (void*)getJIT()->findSymbol(name).getAddress();
+        }
+
+        static Interpreter & getInterpreter() {
+            static Interpreter interp(
+                    [] (ScmProg & prog, P_ScmEnv env) {
+                        return compileExpression(prog, env);
+                    },
+                    findSymbolAddress,
+                    [] (shared_ptr<Module> mod) {
+                        ScmJIT * jit = getJIT();
+                        mod->setDataLayout(jit->getTargetMachine().createDataLayout());
+                        jit->addModule(mod);
+                    }
+            );
+            return interp;
+        }
+
+        class JitSetup {
+        public:
+            JitSetup() {
+                initCWDPath();
+            }
+
+            ~JitSetup() {
+                GCed<ScmEnv>::cleanup();
+            }
+        };
+
+        static JitSetup jit_setup;
+
+        extern "C" {
+            scm_type_t * jit_make_base_nspace() {
+                GCed<ScmEnv> * env = new GCed<ScmEnv>(nullptr);
+                env->link_lib = true;
+                initGlobalEnvironment(env, __llscheme_metainfo__);
+
+                return alloc_nspace(env);
+            }
+
+            scm_type_t * jit_eval(scm_type_t * expr, scm_type_t * nspace) {
+                EvalScope scope;
+                // The type of ns is checked by scm_eval
+                scm_ptr_t ns = nspace;
+                P_ScmEnv env = ns.asNspace->env->getSharedPtr();
+
+                // The same expression in an unchanged namespace compiles to the same code
+                string key;
+                uint64_t generation = env->getGeneration();
+                bool cacheable = EvalCache::makeKey(expr, generation, key);
+                if (!getPendingExprs().empty()) {
+                    installCompiled();
+                }
+                if (cacheable) {
+                    if (CompiledExpr * cached = getEvalCache().find(key)) {
+                        D(cerr << "eval: cached expression" << endl);
+                        // The entry may be gone after the call
+                        CompiledExpr compiled = *cached;
+                        scm_type_t * result = compiled.func();
+                        if (compiled.sections && !detachResult(result, compiled)) {
+                            getEvalCache().keep(key, compiled);
+                        }
+                        return result;
+                    }
+                }
+
+                shared_ptr<ScmProg> prog = parseExpression(expr, env);
+                if (!prog) {
+                    EVAL_FAILED();
+                }
+
+                if (Interpreter::enabled() && Interpreter::canInterpret(*prog)) {
+                    // Expressions evaluated only a few times are not worth compiling
+                    bool hot = cacheable && getEvalCache().countEval(key) >= Interpreter::ExprJitThreshold;
+                    // The hot ones are interpreted until their code compiled in the background is installed
+                    bool background = hot && compilesInBackground() && !definesGlobals(*prog);
+                    if (!hot || background) {
+                        D(cerr << "eval: interpreted expression" << endl);
+                        scm_type_t * result = getInterpreter().run(prog, env);
+                        if (background && env->getGeneration() == generation) {
+                            compileInBackground(key, *prog, env);
+                        }
+                        return result;
+                    }
+                }
+
+                CompiledExpr compiled;
+                // The code of a one-off expression is freed by the reaper
+                bool one_off = !cacheable && !definesGlobals(*prog);
+                compiled.func = compileExpression(*prog, env, &compiled.handle, !one_off);
+                // The definitions are used by the following code
+                if (!definesGlobals(*prog)) {
+                    compiled.sections = getJIT()->getSections(compiled.handle);
+                }
+
+                // Expressions with definitions change the namespace, they aren't cached
+                bool cached = cacheable && env->getGeneration() == generation;
+                if (cached) {
+                    getEvalCache().add(key, compiled);
+                }
+
+                // Call the compiled function
+                scm_type_t * result = compiled.func();
+                if (compiled.sections) {
+                    if (!detachResult(result, compiled)) {
+                        if (cached) {
+                            getEvalCache().keep(key, compiled);
+                        }
+                    }
+                    else if (!cached) {
+                        getReaper().retire(compiled.handle);
+                    }
+                }
+                return result;
+            }
+
+            scm_type_t * jit_eval_batch(scm_type_t * exprs, scm_type_t * nspace) {
+                EvalScope scope;
+                // The types are checked by scm_eval_batch
+                scm_ptr_t ns = nspace;
+                P_ScmEnv env = ns.asNspace->env->getSharedPtr();
+
+                struct BatchExpr {
+                    string name;
+                    // Added to the lazy JIT as it is
+                    shared_ptr<Module> mod;
+                    CompileService::ObjectFuture object;
+                };
+                vector<BatchExpr> batch;
+
+                // Resolved and generated in order, so that the expressions can refer
+                // to the definitions of the previous ones. The workers compile them in parallel.
+                for (scm_ptr_t e = exprs; e.tag() == S_CONS; e = e.asCons->cdr) {
+                    shared_ptr<ScmProg> prog = parseExpression(e.asCons->car, env);
+                    if (!prog) {
+                        EVAL_FAILED();
+                    }
+
+                    BatchExpr item;
+                    item.name = getUniqID("__anon_expr#");
+                    shared_ptr<Module> mod = genExpression(*prog, env, item.name);
+                    if (getJIT()->isLazy()) {
+                        item.mod = mod;
+                    }
+                    else {
+                        item.object = getCompileService().submit(*mod);
+                    }
+                    batch.push_back(move(item));
+                }
+
+                // Installed in order too, the objects are linked to the previous ones
+                ScmJIT * jit = getJIT();
+                vector<scm_expr_ptr_t> funcs;
+                for (auto & item: batch) {
+                    if (item.mod) {
+                        jit->addModule(item.mod);
+                        JITSymbol expr_func_symbol = jit->findSymbol(item.name);
+                        assert(expr_func_symbol);
+                        funcs.push_back((scm_expr_ptr_t)expr_func_symbol.getAddress());
+                        continue;
+                    }
+
+                    shared_ptr<CompileService::Object> object = item.object.get();
+                    if (!object) {
+                        EVAL_FAILED();
+                    }
+                    ScmJIT::ModuleHandleT handle;
+                    funcs.push_back(installObject(move(object), item.name, handle));
+                }
+
+                scm_type_t * result = SCM_NULL;
+                for (auto func: funcs) {
+                    result = func();
+                }
+                return result;
+            }
+
+            static scm_type_t * read_atom(const unique_ptr<Reader> & r) {
+                const Token * tok = r->currToken();
+
+                switch (tok->t) {
+                    case STR:
+                        return alloc_str(tok->name.c_str());
+                    case SYM:
+                        return alloc_sym(tok->name.c_str());
+                    case INT:
+                        return alloc_int(tok->int_val);
+                    case FLOAT:
+                        return alloc_float(tok->float_val);
+                    case ERR:
+                        READ_FAILED();
+                    default:;
+                }
+
+                if (tok->t != KWRD) {
+                    fprintf(stderr, "Invalid token for an atom.\n");
+                    READ_FAILED();
+                }
+                switch (tok->kw) {
+                    case KW_TRUE:
+                        return SCM_TRUE;
+                    case KW_FALSE:
+                        return SCM_FALSE;
+                    case KW_NULL:
+                        return SCM_NULL;
+                    case KW_RPAR:
+                        fprintf(stderr, "Unexpected \")\".\n");
+                        READ_FAILED();
+                    default:
+                        return alloc_sym(tok->name.c_str());
+                }
+            }
+
+            static scm_type_t * read_expr(const unique_ptr<Reader> & r);
+
+            static scm_type_t * read_list(const unique_ptr<Reader> & r) {
+                const Token * tok = r->currToken();
+
+                if (tok->t == KWRD && tok->kw == KW_RPAR) {
+                    return SCM_NULL;
+                }
+
+                scm_type_t * car = read_expr(r);
+                r->nextToken();
+                scm_type_t * cdr = read_list(r);
+
+                return alloc_cons(car, cdr);
+            }
+
+            static scm_type_t * read_expr(const unique_ptr<Reader> & r) {
+                const Token * tok = r->currToken();
+                scm_type_t * expr;
+
+                if (!tok) {
+                    return SCM_EOF;
+                }
+
+                if (tok->t == KWRD && tok->kw == KW_LPAR) {
+                    r->nextToken();
+                    expr = read_list(r);
+
+                    tok = r->currToken();
+                    if (tok->t != KWRD || tok->kw != KW_RPAR) {
+                        fprintf(stderr, "Expected token \")\".\n");
+                        READ_FAILED();
+                    }
+                }
+                else if(tok->t == KWRD && tok->kw == KW_QUCHAR) {
+                    r->nextToken();
+
+                    scm_type_t * quoted = alloc_cons(read_expr(r), SCM_NULL);
+                    expr = alloc_cons(alloc_sym("quote"), quoted);
+                }
+                else {
+                    expr = read_atom(r);
+                }
+
+                return expr;
+            }
+
+            scm_type_t * jit_read() {
+                readlinestream & readlns = getReadlineStream();
+                readlns.setPrompt("> ");
+                unique_ptr<Reader> r = make_unique<FileReader>(readlns);
+
+                r->nextToken();
+                return read_expr(r);
+            }
+        }
+    }
+}
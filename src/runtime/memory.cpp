@@ -1,24 +1,54 @@
 #include <gc.h>
+#include <gc_typed.h>
 #include <cstring>
+#include <cstddef>
+#include <string>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
 #include "../../include/runtime/memory.h"
-#include "../../include/environment.hpp"
 
 namespace llscm {
     namespace runtime {
 
-        void mem_cleanup() {
-            GCed<ScmEnv>::cleanup();
+        // Objects without pointers to other heap objects are allocated
+        // with GC_MALLOC_ATOMIC so the collector never scans their payload.
+        // Cons cells and functions get a typed descriptor marking
+        // only the fields which really point to the GC heap.
+        static GC_descr cons_descr() {
+            static GC_descr descr = [] () {
+                GC_word bitmap[GC_BITMAP_SIZE(scm_cons_t)] = { 0 };
+                GC_set_bit(bitmap, GC_WORD_OFFSET(scm_cons_t, car));
+                GC_set_bit(bitmap, GC_WORD_OFFSET(scm_cons_t, cdr));
+                return GC_make_descriptor(bitmap, GC_WORD_LEN(scm_cons_t));
+            }();
+            return descr;
+        }
+
+        static GC_descr func_descr() {
+            // Function pointers point to code, only the context is on the heap
+            static GC_descr descr = [] () {
+                GC_word bitmap[GC_BITMAP_SIZE(scm_func_t)] = { 0 };
+                GC_set_bit(bitmap, GC_WORD_OFFSET(scm_func_t, ctxptr));
+                return GC_make_descriptor(bitmap, GC_WORD_LEN(scm_func_t));
+            }();
+            return descr;
         }
 
         scm_type_t * alloc_int(int64_t value) {
-            scm_ptr_t obj = GC_MALLOC(sizeof(scm_int_t));
+            if (value >= FIXNUM_MIN && value <= FIXNUM_MAX) {
+                return make_fixnum(value);
+            }
+
+            // Only values which do not fit into a fixnum are boxed
+            scm_ptr_t obj = GC_MALLOC_ATOMIC(sizeof(scm_int_t));
             obj->tag = S_INT;
             obj.asInt->value = value;
             return obj;
         }
 
         scm_type_t * alloc_float(double value) {
-            scm_ptr_t obj = GC_MALLOC(sizeof(scm_float_t));
+            scm_ptr_t obj = GC_MALLOC_ATOMIC(sizeof(scm_float_t));
             obj->tag = S_FLOAT;
             obj.asFloat->value = value;
             return obj;
@@ -46,7 +76,7 @@ namespace llscm {
             uint32_t str_alloc_size = sizeof(scm_str_t);
             str_alloc_size += len * sizeof(char);
 
-            scm_ptr_t obj = GC_MALLOC(str_alloc_size);
+            scm_ptr_t obj = GC_MALLOC_ATOMIC(str_alloc_size);
             obj->tag = S_STR;
             obj.asStr->len = (int32_t)len;
             strcpy(obj.asStr->str, str);
@@ -54,16 +84,98 @@ namespace llscm {
             return obj;
         }
 
+        // Every distinct symbol exists exactly once, so symbols
+        // can be compared by pointer. The table holds the symbols weakly:
+        // the entries are hidden pointers registered as disappearing links,
+        // the GC clears them when nothing else refers to the symbol.
+        // Symbols defined by the compiled modules aren't on the GC heap,
+        // their entries are never cleared.
+        struct SymTable {
+            std::unordered_map<std::string, GC_hidden_pointer> entries;
+            // The cleared entries are removed when the table grows past this size
+            size_t sweep_size = 1024;
+            // Symbols which are never collected (see alloc_pinned_sym)
+            std::unordered_set<scm_type_t*> pinned;
+        };
+
+        static SymTable & sym_table() {
+            // Library constructors may intern symbols before
+            // the static objects of this file are initialized.
+            static SymTable table;
+            return table;
+        }
+
+        static void * reveal_sym(void * entry) {
+            GC_hidden_pointer hidden = *(GC_hidden_pointer*)entry;
+            return hidden ? GC_REVEAL_POINTER(hidden) : nullptr;
+        }
+
+        // The pointer is revealed under the allocation lock,
+        // the GC cannot clear the link in the meantime.
+        static scm_type_t * find_sym(GC_hidden_pointer & entry) {
+            return (scm_type_t*)GC_call_with_alloc_lock(reveal_sym, &entry);
+        }
+
+        static void sweep_sym_table(SymTable & table) {
+            for (auto it = table.entries.begin(); it != table.entries.end();) {
+                if (!it->second) {
+                    it = table.entries.erase(it);
+                }
+                else {
+                    ++it;
+                }
+            }
+            table.sweep_size = std::max(table.sweep_size, 2 * table.entries.size());
+        }
+
+        scm_type_t * intern_static_sym(scm_type_t * sym) {
+            scm_ptr_t obj = sym;
+            GC_hidden_pointer & entry = sym_table().entries[obj.asSym->sym];
+            if (scm_type_t * known = find_sym(entry)) {
+                return known;
+            }
+            entry = GC_HIDE_POINTER(sym);
+            return sym;
+        }
+
         scm_type_t * alloc_sym(const char *sym) {
+            auto & table = sym_table();
+            auto it = table.entries.find(sym);
+            if (it != table.entries.end()) {
+                if (scm_type_t * known = find_sym(it->second)) {
+                    return known;
+                }
+            }
+
             size_t len = strlen(sym);
             uint32_t sym_alloc_size = sizeof(scm_sym_t);
             sym_alloc_size += len * sizeof(char);
 
-            scm_ptr_t obj = GC_MALLOC(sym_alloc_size);
+            // May run a collection which clears some of the entries
+            scm_ptr_t obj = GC_MALLOC_ATOMIC(sym_alloc_size);
             obj->tag = S_SYM;
             obj.asSym->len = (int32_t)len;
             strcpy(obj.asSym->sym, sym);
 
+            if (table.entries.size() >= table.sweep_size) {
+                sweep_sym_table(table);
+            }
+            // The nodes of the map don't move, the link stays valid
+            GC_hidden_pointer & entry = table.entries[sym];
+            entry = GC_HIDE_POINTER((scm_type_t*)obj);
+            GC_general_register_disappearing_link((void**)&entry, obj);
+
+            return obj;
+        }
+
+        scm_type_t * alloc_pinned_sym(const char *sym) {
+            // The code and the data of the JIT modules are not scanned by the GC,
+            // an uncollectable cell keeps each symbol they refer to
+            scm_type_t * obj = alloc_sym(sym);
+            if (sym_table().pinned.insert(obj).second) {
+                scm_type_t ** root = (scm_type_t**)GC_MALLOC_UNCOLLECTABLE(sizeof(scm_type_t*));
+                *root = obj;
+            }
             return obj;
         }
 
@@ -73,7 +185,7 @@ namespace llscm {
 
         scm_type_t * alloc_func(int32_t argc, scm_fnptr_t fnptr,
                                 al_wrapper_t wrfnptr, scm_type_t ** ctxptr) {
-            scm_ptr_t obj = GC_MALLOC(sizeof(scm_func_t));
+            scm_ptr_t obj = GC_malloc_explicitly_typed(sizeof(scm_func_t), func_descr());
             obj->tag = S_FUNC;
             obj.asFunc->argc = argc;
             obj.asFunc->fnptr = fnptr;
@@ -84,7 +196,7 @@ namespace llscm {
         }
 
         scm_type_t * alloc_cons(scm_type_t * car, scm_type_t * cdr) {
-            scm_ptr_t obj = GC_MALLOC(sizeof(scm_cons_t));
+            scm_ptr_t obj = GC_malloc_explicitly_typed(sizeof(scm_cons_t), cons_descr());
             obj->tag = S_CONS;
             obj.asCons->car = car;
             obj.asCons->cdr = cdr;
@@ -101,7 +213,8 @@ namespace llscm {
         }
 
         scm_type_t * alloc_file(FILE * handle) {
-            scm_ptr_t obj = GC_MALLOC(sizeof(scm_file_t));
+            // The FILE structure itself is owned by libc
+            scm_ptr_t obj = GC_MALLOC_ATOMIC(sizeof(scm_file_t));
             obj->tag = S_FILE;
             obj.asFile->handle = handle;
 
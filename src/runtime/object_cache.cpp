@@ -0,0 +1,126 @@
+#include <cstdlib>
+#include <cstring>
+#include <dlfcn.h>
+#include <sys/stat.h>
+#include <llvm/Config/llvm-config.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#include "../../include/runtime/object_cache.hpp"
+#include "../../include/runtime/memory.h"
+#include "../../include/debug.hpp"
+
+namespace llscm {
+    namespace runtime {
+        using namespace std;
+        using namespace llvm;
+
+        static const char * KeyPrefix = "llscm-";
+
+        // Nothing is written to the disk unless asked for,
+        // the cache has no size limit
+        static string getCacheDir() {
+            const char * env = getenv("LLSCHEME_JIT_CACHE");
+            if (!env || !strcmp(env, "0")) {
+                return "";
+            }
+            return env;
+        }
+
+        DiskObjectCache * DiskObjectCache::get() {
+            static unique_ptr<DiskObjectCache> cache = [] () -> unique_ptr<DiskObjectCache> {
+                string dir = getCacheDir();
+                if (dir.empty() || sys::fs::create_directories(dir)) {
+                    return nullptr;
+                }
+                return unique_ptr<DiskObjectCache>(new DiskObjectCache(dir));
+            }();
+            return cache.get();
+        }
+
+        // Rebuilding a library changes its size or time
+        static void hashLibrary(MD5 & hash, void * addr) {
+            Dl_info info;
+            struct stat st;
+            if (dladdr(addr, &info) && info.dli_fname && !stat(info.dli_fname, &st)) {
+                hash.update(StringRef(info.dli_fname));
+                hash.update(to_string(st.st_size));
+                hash.update(to_string(st.st_mtime));
+            }
+        }
+
+        string DiskObjectCache::cacheKey(StringRef bitcode, StringRef target, unsigned opt_level) {
+            static const string libs = [] () {
+                MD5 hash;
+                hash.update(LLVM_VERSION_STRING);
+                // The compiler and the runtime library
+                hashLibrary(hash, (void*)&DiskObjectCache::get);
+                hashLibrary(hash, (void*)&alloc_sym);
+                MD5::MD5Result res;
+                hash.final(res);
+                SmallString<32> str;
+                MD5::stringifyResult(res, str);
+                return str.str().str();
+            }();
+
+            MD5 hash;
+            hash.update(libs);
+            hash.update(target);
+            hash.update(to_string(opt_level));
+            hash.update(bitcode);
+            MD5::MD5Result res;
+            hash.final(res);
+            SmallString<32> str;
+            MD5::stringifyResult(res, str);
+            return KeyPrefix + str.str().str();
+        }
+
+        bool DiskObjectCache::objectPath(const Module * mod, SmallVectorImpl<char> & path) const {
+            const string & id = mod->getModuleIdentifier();
+            if (!StringRef(id).startswith(KeyPrefix)) {
+                return false;
+            }
+            path.assign(dir.begin(), dir.end());
+            sys::path::append(path, id + ".o");
+            return true;
+        }
+
+        unique_ptr<MemoryBuffer> DiskObjectCache::getObject(const Module * mod) {
+            SmallString<128> path;
+            if (!objectPath(mod, path)) {
+                return nullptr;
+            }
+            ErrorOr<unique_ptr<MemoryBuffer>> buf = MemoryBuffer::getFile(path, -1, false);
+            if (!buf) {
+                return nullptr;
+            }
+            D(cerr << "DiskObjectCache: loaded " << path.str().str() << endl);
+            return move(*buf);
+        }
+
+        void DiskObjectCache::notifyObjectCompiled(const Module * mod, MemoryBufferRef obj) {
+            SmallString<128> path;
+            if (!objectPath(mod, path)) {
+                return;
+            }
+            // Written to a temporary file and renamed, other processes may read the same key
+            int fd;
+            SmallString<128> tmp_path;
+            if (sys::fs::createUniqueFile(Twine(path) + ".%%%%%%.tmp", fd, tmp_path)) {
+                return;
+            }
+            bool failed;
+            {
+                raw_fd_ostream os(fd, true);
+                os << obj.getBuffer();
+                os.close();
+                failed = os.has_error();
+                os.clear_error();
+            }
+            if (failed || sys::fs::rename(tmp_path, path)) {
+                sys::fs::remove(tmp_path);
+            }
+        }
+    }
+}
@@ -1,5 +1,6 @@
 #include <cstdlib>
 #include <cstdio>
+#include <cstdarg>
 #include <cstring>
 #include <ctime>
 #include <string>
@@ -7,61 +8,82 @@
 #include <cinttypes>
 #include <vector>
 #include <iostream>
-#include <llvm/ADT/STLExtras.h>
-#include <fs_helpers.hpp>
+#include <sstream>
+#include <gc.h>
+#ifndef LLSCM_STATIC_RUNTIME
+#include <dlfcn.h>
+#endif
 #include "../../include/runtime.h"
 #include "../../include/runtime/internal.hpp"
-#include "../../include/runtime/readlinestream.hpp"
-#include "../../include/reader.hpp"
-#include "../../include/parser.hpp"
-#include "../../include/environment.hpp"
-#include "../../include/codegen.hpp"
+#include "../../include/runtime/jit.h"
+#include "../../include/debug.hpp"
 
 #define EPSILON 10E-9
 
 namespace llscm {
     namespace runtime {
-        using namespace llvm;
-        using namespace orc;
-
-        InitJIT::InitJIT() {
-            InitializeNativeTarget();
-            InitializeNativeTargetAsmPrinter();
-            InitializeNativeTargetAsmParser();
-            jit = make_unique<ScmJIT>();
-            D(std::cerr << "InitJIT completed" << std::endl);
-        }
-
-        ScmJIT * InitJIT::getJIT() {
-            return jit.get();
-        }
-
-        static string getUniqID(const string & name) {
-            static ScmNameGen gen;
-            return gen.getUniqID(name);
-        }
-
-        static ScmJIT * getJIT() {
-            static InitJIT jit_obj;
-            return jit_obj.getJIT();
-        }
-
-        static readlinestream & getReadlineStream() {
-            static readlinestream readlns;
-            return readlns;
-        }
+        using namespace std;
 
         LibSetup::LibSetup() {
             srand((uint32_t)time(nullptr));
-            initCWDPath();
-        }
-
-        LibSetup::~LibSetup() {
-           mem_cleanup();
         }
 
         static LibSetup lib_setup;
 
+        // The compiler needed by eval and read is in a separate library.
+        // It's loaded on the first use, so the programs which don't call eval
+        // don't have to load and relocate LLVM at startup.
+        struct JitLib {
+            decltype(&jit_make_base_nspace) make_base_nspace;
+            decltype(&jit_eval) eval;
+            decltype(&jit_eval_batch) eval_batch;
+            decltype(&jit_read) read;
+        };
+
+#ifdef LLSCM_STATIC_RUNTIME
+        static const JitLib & getJitLib(const char * caller) {
+            // The compiler library would bring its own copy of the runtime and the GC
+            RUNTIME_ERROR("%s is not available in statically linked programs.\n", caller);
+        }
+#else
+        static string getJitLibPath() {
+            // Installed next to the runtime library
+            Dl_info info;
+            if (dladdr((void*)&getJitLibPath, &info) && info.dli_fname) {
+                string path = info.dli_fname;
+                size_t slash = path.rfind('/');
+                if (slash != string::npos) {
+                    return path.substr(0, slash + 1) + LLSCMJIT_LIB;
+                }
+            }
+            return LLSCMJIT_LIB;
+        }
+
+        static const JitLib & getJitLib(const char * caller) {
+            static JitLib lib = [] () {
+                void * handle = dlopen(getJitLibPath().c_str(), RTLD_NOW);
+                if (!handle) {
+                    // Fall back to the default search path
+                    handle = dlopen(LLSCMJIT_LIB, RTLD_NOW);
+                }
+                if (!handle) {
+                    RUNTIME_ERROR("Cannot load the compiler library: %s\n", dlerror());
+                }
+                D(cerr << "Loaded " << LLSCMJIT_LIB << endl);
+
+                JitLib l;
+                l.make_base_nspace = (decltype(l.make_base_nspace))dlsym(handle, "jit_make_base_nspace");
+                l.eval = (decltype(l.eval))dlsym(handle, "jit_eval");
+                l.eval_batch = (decltype(l.eval_batch))dlsym(handle, "jit_eval_batch");
+                l.read = (decltype(l.read))dlsym(handle, "jit_read");
+                if (!l.make_base_nspace || !l.eval || !l.eval_batch || !l.read) {
+                    RUNTIME_ERROR("Invalid compiler library: %s\n", LLSCMJIT_LIB);
+                }
+                return l;
+            }();
+            return lib;
+        }
+#endif
 
         scm_type_t Constant::scm_null = { S_NIL };
         scm_type_t Constant::scm_true = { S_TRUE };
@@ -95,6 +117,17 @@ namespace llscm {
         SCM_VARARGS_WRAPPER(func) \
         SCM_VARGLIST_WRAPPER(func)
 
+        // Entry point used by the compiler when the call has exactly two arguments
+#define SCM_BINARY_WRAPPER(func) \
+        scm_type_t * func##2(scm_type_t * a, scm_type_t * b) { \
+            int32_t idx = 0; \
+            scm_type_t * args[] = { b, nullptr }; \
+            return internal_##func( \
+                [a] () { return a; }, \
+                [&args, &idx] () { return args[idx++]; } \
+            ); \
+        }
+
         // Template functions cannot have C linkage, so we need to save
         // pointers to their instantiated variants.
 #define SCM_ARGLIST_WRAPPER(func) \
@@ -110,6 +143,10 @@ namespace llscm {
         SCM_VA_WRAPPERS(scm_minus);
         SCM_VA_WRAPPERS(scm_times);
         SCM_VA_WRAPPERS(scm_div);
+        SCM_BINARY_WRAPPER(scm_plus);
+        SCM_BINARY_WRAPPER(scm_minus);
+        SCM_BINARY_WRAPPER(scm_times);
+        SCM_BINARY_WRAPPER(scm_div);
         SCM_VA_WRAPPERS(scm_list);
         SCM_VA_WRAPPERS(scm_current_nspace);
 
@@ -121,7 +158,7 @@ namespace llscm {
                 return SCM_NULL;
             }
 
-            switch (obj->tag) {
+            switch (obj.tag()) {
                 case S_STR:
                     printf("%s", obj.asStr->str);
                     break;
@@ -129,7 +166,7 @@ namespace llscm {
                     printf("%s", obj.asSym->sym);
                     break;
                 case S_INT:
-                    printf("%" PRId64, obj.asInt->value);
+                    printf("%" PRId64, obj.intValue());
                     break;
                 case S_FLOAT:
                     printf("%g", obj.asFloat->value);
@@ -147,7 +184,7 @@ namespace llscm {
                     printf("("); // TODO: we should quote the top level list
                     list_foreach(obj.asCons, [](scm_ptr_t elem) {
                         scm_display(elem.asCons->car);
-                        if (elem.asCons->cdr->tag == S_CONS) {
+                        if (scm_ptr_t(elem.asCons->cdr).tag() == S_CONS) {
                             printf(" ");
                         }
                     });
@@ -180,44 +217,78 @@ namespace llscm {
             return SCM_NULL;
         }
 
-        //scm_type_t * scm_gt(scm_ptr_t a, scm_ptr_t b) {
-        DEF_WITH_WRAPPER(scm_gt, scm_ptr_t a, scm_ptr_t b) {
-            if (a->tag == S_INT) {
-                if (b->tag == S_INT) {
-                    return a.asInt->value > b.asInt->value ? SCM_TRUE : SCM_FALSE;
+        // Numeric comparison shared by the ordering predicates.
+        // Floats are compared by their difference d = a - b.
+        template<typename F1, typename F2>
+        static inline scm_type_t * num_compare(const char * fname, scm_ptr_t a, scm_ptr_t b,
+                                               F1 int_cmp, F2 float_cmp) {
+            double d;
+            if (a.tag() == S_INT) {
+                if (b.tag() == S_INT) {
+                    return int_cmp(a.intValue(), b.intValue()) ? SCM_TRUE : SCM_FALSE;
                 }
-                if (b->tag == S_FLOAT) {
-                    return (a.asInt->value - b.asFloat->value) > EPSILON ? SCM_TRUE : SCM_FALSE;
+                if (b.tag() != S_FLOAT) {
+                    RUNTIME_ERROR("Invalid type of argument given to %s.\n", fname);
                 }
-                INVALID_ARG_TYPE();
+                d = a.intValue() - b.asFloat->value;
             }
-            if (a->tag == S_FLOAT) {
-                if (b->tag == S_INT) {
-                    return (a.asFloat->value - b.asInt->value) > EPSILON ? SCM_TRUE : SCM_FALSE;
+            else if (a.tag() == S_FLOAT) {
+                if (b.tag() == S_INT) {
+                    d = a.asFloat->value - b.intValue();
                 }
-                if (b->tag == S_FLOAT) {
-                    return (a.asFloat->value - b.asFloat->value) > EPSILON ? SCM_TRUE : SCM_FALSE;
+                else if (b.tag() == S_FLOAT) {
+                    d = a.asFloat->value - b.asFloat->value;
+                }
+                else {
+                    RUNTIME_ERROR("Invalid type of argument given to %s.\n", fname);
                 }
-                INVALID_ARG_TYPE();
             }
-            INVALID_ARG_TYPE();
+            else {
+                RUNTIME_ERROR("Invalid type of argument given to %s.\n", fname);
+            }
+            return float_cmp(d) ? SCM_TRUE : SCM_FALSE;
+        }
+
+        //scm_type_t * scm_gt(scm_ptr_t a, scm_ptr_t b) {
+        DEF_WITH_WRAPPER(scm_gt, scm_ptr_t a, scm_ptr_t b) {
+            return num_compare(__func__, a, b,
+                               [] (int64_t x, int64_t y) { return x > y; },
+                               [] (double d) { return d > EPSILON; });
+        }
+
+        DEF_WITH_WRAPPER(scm_lt, scm_ptr_t a, scm_ptr_t b) {
+            return num_compare(__func__, a, b,
+                               [] (int64_t x, int64_t y) { return x < y; },
+                               [] (double d) { return d < -EPSILON; });
+        }
+
+        DEF_WITH_WRAPPER(scm_le, scm_ptr_t a, scm_ptr_t b) {
+            return num_compare(__func__, a, b,
+                               [] (int64_t x, int64_t y) { return x <= y; },
+                               [] (double d) { return d <= EPSILON; });
+        }
+
+        DEF_WITH_WRAPPER(scm_ge, scm_ptr_t a, scm_ptr_t b) {
+            return num_compare(__func__, a, b,
+                               [] (int64_t x, int64_t y) { return x >= y; },
+                               [] (double d) { return d >= -EPSILON; });
         }
 
         DEF_WITH_WRAPPER(scm_num_eq, scm_ptr_t a, scm_ptr_t b) {
-            if (a->tag == S_INT) {
-                if (b->tag == S_INT) {
-                    return a.asInt->value == b.asInt->value ? SCM_TRUE : SCM_FALSE;
+            if (a.tag() == S_INT) {
+                if (b.tag() == S_INT) {
+                    return a.intValue() == b.intValue() ? SCM_TRUE : SCM_FALSE;
                 }
-                if (b->tag == S_FLOAT) {
-                    return fabs(a.asInt->value - b.asFloat->value) < EPSILON ? SCM_TRUE : SCM_FALSE;
+                if (b.tag() == S_FLOAT) {
+                    return fabs(a.intValue() - b.asFloat->value) < EPSILON ? SCM_TRUE : SCM_FALSE;
                 }
                 INVALID_ARG_TYPE();
             }
-            if (a->tag == S_FLOAT) {
-                if (b->tag == S_INT) {
-                    return fabs(a.asFloat->value - b.asInt->value) < EPSILON ? SCM_TRUE : SCM_FALSE;
+            if (a.tag() == S_FLOAT) {
+                if (b.tag() == S_INT) {
+                    return fabs(a.asFloat->value - b.intValue()) < EPSILON ? SCM_TRUE : SCM_FALSE;
                 }
-                if (b->tag == S_FLOAT) {
+                if (b.tag() == S_FLOAT) {
                     return fabs(a.asFloat->value - b.asFloat->value) < EPSILON ? SCM_TRUE : SCM_FALSE;
                 }
                 INVALID_ARG_TYPE();
@@ -230,7 +301,7 @@ namespace llscm {
         }
 
         DEF_WITH_WRAPPER(scm_car, scm_ptr_t obj) {
-            if (obj->tag != S_CONS) {
+            if (obj.tag() != S_CONS) {
                 INVALID_ARG_TYPE();
             }
 
@@ -238,7 +309,7 @@ namespace llscm {
         }
 
         DEF_WITH_WRAPPER(scm_cdr, scm_ptr_t obj) {
-            if (obj->tag != S_CONS) {
+            if (obj.tag() != S_CONS) {
                 INVALID_ARG_TYPE();
             }
 
@@ -247,7 +318,7 @@ namespace llscm {
 
         DEF_WITH_WRAPPER(scm_is_null, scm_ptr_t obj) {
             // TODO: make sure SCM_NULL is a singleton so we can compare pointers only
-            return obj->tag == S_NIL ? SCM_TRUE : SCM_FALSE;
+            return obj.tag() == S_NIL ? SCM_TRUE : SCM_FALSE;
         }
 
         // Used only internally - no need for a wrapper
@@ -260,7 +331,7 @@ namespace llscm {
         }
 
         DEF_WITH_WRAPPER(scm_vector_length, scm_ptr_t obj) {
-            if (obj->tag != S_VEC) {
+            if (obj.tag() != S_VEC) {
                 INVALID_ARG_TYPE();
             }
 
@@ -269,15 +340,20 @@ namespace llscm {
         }
 
         DEF_WITH_WRAPPER(scm_vector_ref, scm_ptr_t obj, scm_ptr_t idx) {
-            if (obj->tag != S_VEC) {
+            if (obj.tag() != S_VEC) {
                 INVALID_ARG_TYPE();
             }
 
-            if (idx->tag != S_INT) {
+            if (idx.tag() != S_INT) {
                 INVALID_ARG_TYPE();
             }
 
-            return obj.asVec->elems[idx.asInt->value];
+            int64_t i = idx.intValue();
+            if (i < 0 || i >= obj.asVec->size) {
+                RUNTIME_ERROR("Vector index %" PRId64 " out of range in %s.\n", i, __func__);
+            }
+
+            return obj.asVec->elems[i];
         }
 
         DEF_WITH_WRAPPER(scm_cmd_args) {
@@ -285,11 +361,11 @@ namespace llscm {
         }
 
         DEF_WITH_WRAPPER(scm_length, scm_ptr_t list) {
-            if (list->tag == S_NIL) {
+            if (list.tag() == S_NIL) {
                 return alloc_int(0);
             }
 
-            if (list->tag != S_CONS) {
+            if (list.tag() != S_CONS) {
                 INVALID_ARG_TYPE();
             }
 
@@ -302,200 +378,64 @@ namespace llscm {
         }
 
         DEF_WITH_WRAPPER(scm_apply, scm_ptr_t func, scm_ptr_t list) {
-            if (func->tag != S_FUNC) {
+            if (func.tag() != S_FUNC) {
                 INVALID_ARG_TYPE();
             }
 
             bool args_any_count = func.asFunc->argc == -1;
 
-            if (list->tag == S_NIL && (func.asFunc->argc == 0 || args_any_count)) {
-                // Call a function without arguments
-                // with an optional context pointer (or null).
-                // Extra argument is fine because we use
-                // the C calling convention. That means the caller
-                // cleans up arguments from stack.
-                return func.asFunc->fnptr((scm_type_t*)func.asFunc->ctxptr);
-            }
-
-            if (list->tag != S_CONS) {
+            if (list.tag() != S_CONS && list.tag() != S_NIL) {
                 INVALID_ARG_TYPE();
             }
 
             int64_t argc = 0;
             vector<scm_type_t*> arg_vec;
 
-            list_foreach(list, [&arg_vec, &argc](scm_ptr_t elem) {
-                arg_vec.push_back(elem.asCons->car);
-                argc++;
-            });
+            if (list.tag() == S_CONS) {
+                list_foreach(list, [&arg_vec, &argc](scm_ptr_t elem) {
+                    arg_vec.push_back(elem.asCons->car);
+                    argc++;
+                });
+            }
 
             if (!args_any_count && argc != func.asFunc->argc) {
                 error_wrong_arg_num(func.asFunc, argc);
             }
             arg_vec.push_back((scm_type_t*)func.asFunc->ctxptr);
 
+            // Always call through the wrapper. The function itself
+            // may use the fastcc convention of compiled Scheme code.
             return func.asFunc->wrfnptr(&arg_vec[0]);
         }
 
         DEF_WITH_WRAPPER(scm_make_base_nspace) {
-            GCed<ScmEnv> * env = new GCed<ScmEnv>(nullptr);
-            env->link_lib = true;
-            initGlobalEnvironment(env, __llscheme_metainfo__);
-
-            return alloc_nspace(env);
+            return getJitLib(__func__).make_base_nspace();
         }
 
         DEF_WITH_WRAPPER(scm_eval, scm_ptr_t expr, scm_ptr_t ns) {
-            if (ns->tag != S_NSPACE) {
+            if (ns.tag() != S_NSPACE) {
                 INVALID_ARG_TYPE();
             }
-
-            unique_ptr<Reader> r = make_unique<ListReader>(expr);
-            unique_ptr<Parser> p = make_unique<Parser>(r);
-
-            ScmProg prog = p->NT_Prog();
-
-            if (p->fail()) {
-                EVAL_FAILED();
-            }
-
-            P_ScmEnv env = ns.asNspace->env->getSharedPtr();
-            env->setProg(prog);
-
-            if (!prog.CT_Eval(env)) {
-                EVAL_FAILED();
-            }
-
-            /*for (auto & e: prog) {
-                e->printSrc(cerr);
-                cerr << endl;
-            }*/
-
-            string expr_name = getUniqID("__anon_expr#");
-
-            ScmCodeGen cg(getGlobalContext(), &prog);
-            cg.makeExpression(expr_name);
-            cg.run();
-            D(cg.dump());
-
-            // Compile the Module
-            ScmJIT * jit = getJIT();
-            shared_ptr<Module> mod = cg.getModule();
-            mod->setDataLayout(jit->getTargetMachine().createDataLayout());
-
-            // TODO: optimizations (PassManager)
-            jit->addModule(mod);
-            JITSymbol expr_func_symbol = jit->findSymbol(expr_name);
-            assert(expr_func_symbol);
-
-            // Prepare the environment for any future compilation
-            env->setGlobalsAsExternal();
-
-            scm_expr_ptr_t expr_func = (scm_expr_ptr_t)expr_func_symbol.getAddress();
-
-            // Call the compiled function
-            return expr_func();
-        }
-
-        // TODO: Move somewhere else?
-        static scm_type_t * read_atom(const unique_ptr<Reader> & r) {
-            const Token * tok = r->currToken();
-
-            switch (tok->t) {
-                case STR:
-                    return alloc_str(tok->name.c_str());
-                case SYM:
-                    return alloc_sym(tok->name.c_str());
-                case INT:
-                    return alloc_int(tok->int_val);
-                case FLOAT:
-                    return alloc_float(tok->float_val);
-                case ERR:
-                    READ_FAILED();
-                default:;
-            }
-
-            if (tok->t != KWRD) {
-                fprintf(stderr, "Invalid token for an atom.\n");
-                READ_FAILED();
-            }
-            switch (tok->kw) {
-                case KW_TRUE:
-                    return SCM_TRUE;
-                case KW_FALSE:
-                    return SCM_FALSE;
-                case KW_NULL:
-                    return SCM_NULL;
-                case KW_RPAR:
-                    fprintf(stderr, "Unexpected \")\".\n");
-                    READ_FAILED();
-                default:
-                    return alloc_sym(tok->name.c_str());
-            }
+            return getJitLib(__func__).eval(expr, ns);
         }
 
-        static scm_type_t * read_expr(const unique_ptr<Reader> & r);
-
-        static scm_type_t * read_list(const unique_ptr<Reader> & r) {
-            const Token * tok = r->currToken();
-
-            if (tok->t == KWRD && tok->kw == KW_RPAR) {
-                return SCM_NULL;
-            }
-
-            scm_type_t * car = read_expr(r);
-            r->nextToken();
-            scm_type_t * cdr = read_list(r);
-
-            return alloc_cons(car, cdr);
-        }
-
-        static scm_type_t * read_expr(const unique_ptr<Reader> & r) {
-            const Token * tok = r->currToken();
-            scm_type_t * expr;
-
-            if (!tok) {
-                return SCM_EOF;
-            }
-
-            if (tok->t == KWRD && tok->kw == KW_LPAR) {
-                r->nextToken();
-                expr = read_list(r);
-
-                tok = r->currToken();
-                if (tok->t != KWRD || tok->kw != KW_RPAR) {
-                    fprintf(stderr, "Expected token \")\".\n");
-                    READ_FAILED();
-                }
-            }
-            else if(tok->t == KWRD && tok->kw == KW_QUCHAR) {
-                r->nextToken();
-
-                scm_type_t * quoted = alloc_cons(read_expr(r), SCM_NULL);
-                expr = alloc_cons(alloc_sym("quote"), quoted);
-            }
-            else {
-                expr = read_atom(r);
+        DEF_WITH_WRAPPER(scm_eval_batch, scm_ptr_t exprs, scm_ptr_t ns) {
+            if (ns.tag() != S_NSPACE || (exprs.tag() != S_CONS && exprs.tag() != S_NIL)) {
+                INVALID_ARG_TYPE();
             }
-
-            return expr;
+            return getJitLib(__func__).eval_batch(exprs, ns);
         }
 
         DEF_WITH_WRAPPER(scm_read) {
-            readlinestream & readlns = getReadlineStream();
-            readlns.setPrompt("> ");
-            unique_ptr<Reader> r = make_unique<FileReader>(readlns);
-
-            r->nextToken();
-            return read_expr(r);
+            return getJitLib(__func__).read();
         }
 
         DEF_WITH_WRAPPER(scm_is_eof, scm_ptr_t obj) {
-            return obj->tag == S_EOF ? SCM_TRUE : SCM_FALSE;
+            return obj.tag() == S_EOF ? SCM_TRUE : SCM_FALSE;
         }
 
         DEF_WITH_WRAPPER(scm_string_to_symbol, scm_ptr_t obj) {
-            if (obj->tag != S_STR) {
+            if (obj.tag() != S_STR) {
                 INVALID_ARG_TYPE();
             }
 
@@ -503,14 +443,14 @@ namespace llscm {
         }
 
         DEF_WITH_WRAPPER(scm_string_equals, scm_ptr_t a, scm_ptr_t b) {
-            if (a->tag != S_STR || b->tag != S_STR) {
+            if (a.tag() != S_STR || b.tag() != S_STR) {
                 INVALID_ARG_TYPE();
             }
             return !strcmp(a.asStr->str, b.asStr->str) ? SCM_TRUE : SCM_FALSE;
         }
 
         DEF_WITH_WRAPPER(scm_string_append, scm_ptr_t a, scm_ptr_t b) {
-            if (a->tag != S_STR || b->tag != S_STR) {
+            if (a.tag() != S_STR || b.tag() != S_STR) {
                 INVALID_ARG_TYPE();
             }
             string concat = a.asStr->str;
@@ -519,7 +459,7 @@ namespace llscm {
         }
 
         DEF_WITH_WRAPPER(scm_string_replace, scm_ptr_t str, scm_ptr_t a, scm_ptr_t b) {
-            if (str->tag != S_STR || a->tag != S_STR || b->tag != S_STR) {
+            if (str.tag() != S_STR || a.tag() != S_STR || b.tag() != S_STR) {
                 INVALID_ARG_TYPE();
             }
 
@@ -537,7 +477,7 @@ namespace llscm {
         }
 
         DEF_WITH_WRAPPER(scm_string_split, scm_ptr_t str) {
-            if (str->tag != S_STR) {
+            if (str.tag() != S_STR) {
                 INVALID_ARG_TYPE();
             }
 
@@ -554,7 +494,7 @@ namespace llscm {
         }
 
         DEF_WITH_WRAPPER(scm_open_input_file, scm_ptr_t path) {
-            if (path->tag != S_STR) {
+            if (path.tag() != S_STR) {
                 INVALID_ARG_TYPE();
             }
 
@@ -567,7 +507,7 @@ namespace llscm {
         }
 
         DEF_WITH_WRAPPER(scm_close_input_port, scm_ptr_t port) {
-            if (port->tag != S_FILE) {
+            if (port.tag() != S_FILE) {
                 INVALID_ARG_TYPE();
             }
 
@@ -576,7 +516,7 @@ namespace llscm {
         }
 
         DEF_WITH_WRAPPER(scm_read_line, scm_ptr_t port) {
-            if (port->tag != S_FILE) {
+            if (port.tag() != S_FILE) {
                 INVALID_ARG_TYPE();
             }
 
@@ -596,29 +536,35 @@ namespace llscm {
             return ret;
         }
 
+        DEF_WITH_WRAPPER(scm_eq, scm_ptr_t a, scm_ptr_t b) {
+            return a.asType == b.asType ? SCM_TRUE : SCM_FALSE;
+        }
+
         DEF_WITH_WRAPPER(scm_equal, scm_ptr_t a, scm_ptr_t b) {
-            if (a->tag != b->tag) {
+            if (a.tag() != b.tag()) {
                 return SCM_FALSE;
             }
 
-            switch(a->tag) {
+            switch(a.tag()) {
                 case S_STR:
                     return !strcmp(a.asStr->str, b.asStr->str) ? SCM_TRUE : SCM_FALSE;
                 case S_SYM:
-                    return !strcmp(a.asSym->sym, b.asSym->sym) ? SCM_TRUE : SCM_FALSE;
+                    // Symbols are interned
+                    return a.asType == b.asType ? SCM_TRUE : SCM_FALSE;
                 case S_INT:
-                    return a.asInt->value == b.asInt->value ? SCM_TRUE : SCM_FALSE;
+                    return a.intValue() == b.intValue() ? SCM_TRUE : SCM_FALSE;
                 case S_FLOAT:
                     return a.asFloat->value == b.asFloat->value ? SCM_TRUE : SCM_FALSE;
                 case S_CONS: {
                     bool equals = true;
                     scm_ptr_t lena = scm_length(a);
                     scm_ptr_t lenb = scm_length(b);
-                    if (lena.asInt->value != lenb.asInt->value) {
+                    if (lena.intValue() != lenb.intValue()) {
                         equals = false;
                     }
                     else {
-                        list_foreach(zip(a, b), [&equals](scm_ptr_t elem) {
+                        scm_type_t * zip_args[] = { a, b, nullptr };
+                        list_foreach(argl_zip(zip_args), [&equals](scm_ptr_t elem) {
                             scm_ptr_t pair = elem.asCons->car;
                             scm_ptr_t first = pair.asCons->car;
                             scm_ptr_t second = ((scm_ptr_t)pair.asCons->cdr).asCons->car;
@@ -640,26 +586,31 @@ namespace llscm {
                 case S_FALSE:
                 case S_NIL:
                 case S_EOF:
-                    return a->tag == b->tag ? SCM_TRUE : SCM_FALSE;
+                    return a.tag() == b.tag() ? SCM_TRUE : SCM_FALSE;
                 default:
                     return SCM_NULL;
             }
         }
 
         DEF_WITH_WRAPPER(scm_exit, scm_ptr_t code) {
-            if (code->tag != S_INT) {
+            if (code.tag() != S_INT) {
                 INVALID_ARG_TYPE();
             }
 
-            exit(code.asInt->value);
+            exit(code.intValue());
         }
 
         DEF_WITH_WRAPPER(scm_random, scm_ptr_t k) {
-            if (k->tag != S_INT) {
+            if (k.tag() != S_INT) {
                 INVALID_ARG_TYPE();
             }
 
-            return alloc_int(rand() % k.asInt->value);
+            return alloc_int(rand() % k.intValue());
+        }
+
+        DEF_WITH_WRAPPER(scm_collect_garbage) {
+            GC_gcollect();
+            return SCM_NULL;
         }
     }
 }
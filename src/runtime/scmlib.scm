@@ -15,10 +15,6 @@
 	   (car lst)
 	   (list-ref (cdr lst) (- idx 1)))))
 
-(define (>= a b) (or (> a b) (= a b)))
-(define (<= a b) (not (> a b)))
-(define (< a b) (not (>= a b)))
-
 (define (append a b)
   (if (null? a) b (cons (car a) (append (cdr a) b))))
 
@@ -0,0 +1,56 @@
+#include "../include/tailcall.hpp"
+#include "../include/debug.hpp"
+
+namespace llscm {
+    using namespace std;
+
+    static void markTailExpr(ScmFunc * func, ScmObj * expr);
+
+    static void markLastExpr(ScmFunc * func, P_ScmObj & expr_list) {
+        if (expr_list->t != T_CONS) {
+            return;
+        }
+
+        ScmCons * cell = DPC<ScmCons>(expr_list).get();
+        while (cell->cdr->t == T_CONS) {
+            cell = DPC<ScmCons>(cell->cdr).get();
+        }
+        markTailExpr(func, cell->car.get());
+    }
+
+    static void markTailExpr(ScmFunc * func, ScmObj * expr) {
+        // Only the expressions in tail position are visited.
+        // Nested functions are processed when their code is generated.
+        if (auto call = dynamic_cast<ScmCall*>(expr)) {
+            call->tail_call = true;
+            if (!call->indirect) {
+                ScmRef * fn_ref = DPC<ScmRef>(call->fexpr).get();
+                if (fn_ref && fn_ref->refObj().get() == func) {
+                    D(cerr << "self tail call in " << func->name << endl);
+                    call->self_tail_call = true;
+                    func->has_self_tail_call = true;
+                }
+            }
+        }
+        else if (auto if_expr = dynamic_cast<ScmIfSyntax*>(expr)) {
+            markTailExpr(func, if_expr->then_expr.get());
+            markTailExpr(func, if_expr->else_expr.get());
+        }
+        else if (auto let_expr = dynamic_cast<ScmLetSyntax*>(expr)) {
+            markLastExpr(func, let_expr->body_list);
+        }
+        else if (auto and_expr = dynamic_cast<ScmAndSyntax*>(expr)) {
+            markLastExpr(func, and_expr->expr_list);
+        }
+        else if (auto or_expr = dynamic_cast<ScmOrSyntax*>(expr)) {
+            markLastExpr(func, or_expr->expr_list);
+        }
+    }
+
+    void markTailCalls(ScmFunc * func) {
+        if (!func->body_list) {
+            return;
+        }
+        markLastExpr(func, func->body_list);
+    }
+}
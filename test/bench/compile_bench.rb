@@ -0,0 +1,54 @@
+#!/usr/bin/env ruby
+
+# Measures the wall-clock compile time of every given source file.
+#
+# Usage: ./compile_bench.rb [-n RUNS] [-O LEVEL] [-c LABEL=SCHEMEC ...] SOURCE...
+#
+# Every -c option adds a compiler binary to compare (e.g. a build
+# of an older revision). Without it, ../../bin/Release/schemec is used.
+
+require "open3"
+require "optparse"
+require "tmpdir"
+require_relative "../colors"
+
+runs = 5
+optlevel = 3
+configs = []
+
+OptionParser.new do |opts|
+	opts.on("-n RUNS", Integer) { |n| runs = n }
+	opts.on("-O LEVEL", Integer) { |o| optlevel = o }
+	opts.on("-c LABEL=SCHEMEC") { |c| configs << c.split("=", 2) }
+end.parse!
+
+configs << ["current", File.join(__dir__, "../../bin/Release/schemec")] if configs.empty?
+
+def compile_once(schemec, src, optlevel, out)
+	start = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+	_, err, status = Open3.capture3(schemec, src, "-O#{optlevel}", "-o", out)
+	wall = Process.clock_gettime(Process::CLOCK_MONOTONIC) - start
+	abort "#{src} failed:\n#{err}" unless status.success?
+
+	wall * 1000
+end
+
+Dir.mktmpdir do |tmp|
+	out = File.join(tmp, "out.o")
+	totals = Hash.new(0.0)
+
+	ARGV.each do |src|
+		puts src.bold.light_yellow
+		configs.each do |label, schemec|
+			times = Array.new(runs) { compile_once(schemec, src, optlevel, out) }
+			median = times.sort[times.size / 2]
+			totals[label] += median
+			printf("  %-12s %9.1f ms\n", label, median)
+		end
+	end
+
+	puts "total".bold.light_yellow
+	totals.each do |label, total|
+		printf("  %-12s %9.1f ms   (%.1f ms per file)\n", label, total, total / ARGV.size)
+	end
+end
@@ -0,0 +1,29 @@
+; Evaluates many generated definitions with eval-batch, then calls the last one.
+; Compare LLSCHEME_JIT_THREADS=0 with the default (make batch-bench),
+; the workers optimize and compile the definitions in parallel.
+
+(define ns (make-base-namespace))
+(define count 200)
+
+(define (reverse lst)
+  (define (rev lst acc)
+	(if (null? lst) acc (rev (cdr lst) (cons (car lst) acc))))
+  (rev lst null))
+
+; (define (f x y) ...) (define (fx x y) ... (f y x)) ...
+(define (gen-defs n name prev acc)
+  (if (= n 0)
+	 (reverse acc)
+	 (gen-defs (- n 1) (string-append name "x") name
+		(cons (list 'define (list (string->symbol name) 'x 'y)
+				(list 'if '(< x y)
+					(list '+ '(* x y) '(- y x) n)
+					(if prev
+						(list (string->symbol prev) 'y 'x)
+						(list '* '(+ x 1) (list '+ 'y n)))))
+			acc))))
+
+(define defs (gen-defs count "f" #f null))
+
+(eval-batch defs ns)
+(displayln (eval '(fxxx 9 4) ns))
@@ -0,0 +1,31 @@
+; Evaluates a generated program with many local functions, only one of them is called.
+; Compare LLSCHEME_INTERP=0 with LLSCHEME_INTERP=0 LLSCHEME_JIT_LAZY=1 (make lazy-bench),
+; the lazy JIT compiles just the called function.
+
+(define ns (make-base-namespace))
+(define count 500)
+
+; (define (f x y) ...) (define (fx x y) ...) (define (fxx x y) ...) ...
+(define (gen-defs n name acc)
+  (if (= n 0)
+	 acc
+	 (gen-defs (- n 1) (string-append name "x")
+		(cons (list 'define (list (string->symbol name) 'x 'y)
+				(list 'if '(< x y)
+					(list '+ '(* x y) '(- y x) n)
+					(list '* '(+ x 1) (list '+ 'y n))))
+			acc))))
+
+; Refers to all of the functions, so that none of them is removed
+(define (gen-pick i name)
+  (if (= i count)
+	 #f
+	 (list 'if (list '= 'k i) (string->symbol name) (gen-pick (+ i 1) (string-append name "x")))))
+
+(define prog
+  (cons 'let (cons '((z 2))
+	(append (gen-defs count "f" null)
+		(list (list 'define '(pick k) (gen-pick 0 "f"))
+			'((pick 7) z 3))))))
+
+(displayln (eval prog ns))
@@ -0,0 +1,15 @@
+; Evaluates the same expressions over and over, like a REPL or a rule engine.
+; Only the first eval of each expression should be compiled,
+; a definition in the namespace makes the following evals compile again.
+
+(define ns (make-base-namespace))
+(eval '(define (rule x) (* x 2)) ns)
+
+(define (apply-rules n acc)
+  (if (= n 0)
+	 acc
+	 (apply-rules (- n 1) (+ acc ((eval '(lambda (x) (+ (rule x) 1)) ns) n)))))
+
+(displayln (apply-rules 10000 0))
+(eval '(define (rule x) (* x 3)) ns)
+(displayln (apply-rules 10000 0))
@@ -0,0 +1,21 @@
+; Evaluates many different expressions, each of them once, like a REPL session.
+; These are interpreted, the lambda called in the second loop gets compiled.
+
+(define ns (make-base-namespace))
+(eval '(define (square x) (* x x)) ns)
+
+(define (eval-all n acc)
+  (if (= n 0)
+	 acc
+	 (eval-all (- n 1) (+ acc (eval (list 'let (list (list 'y n)) '(+ (square y) 1)) ns)))))
+
+(displayln (eval-all 2000 0))
+
+(define f (eval '(lambda (x) (if (< x 0) 0 (square x))) ns))
+
+(define (call-f n acc)
+  (if (= n 0)
+	 acc
+	 (call-f (- n 1) (+ acc (f n)))))
+
+(displayln (call-f 100000 0))
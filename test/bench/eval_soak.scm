@@ -0,0 +1,19 @@
+; Evaluates a million expressions, 10000 different ones (more than the eval cache holds),
+; so the compiled expressions keep being replaced. Their results refer to constants
+; of the compiled code. make soak-bench checks that the memory use stays bounded.
+
+(define ns (make-base-namespace))
+(eval '(define base 5000) ns)
+
+(define (run-round k acc)
+  (if (= k 0)
+	 acc
+	 (run-round (- k 1)
+		(+ acc (car (cdr (eval (list 'list (list '< 'base k) (list '* k 2) "soak") ns)))))))
+
+(define (run-rounds r acc)
+  (if (= r 0)
+	 acc
+	 (run-rounds (- r 1) (run-round 10000 acc))))
+
+(displayln (run-rounds 100 0))
@@ -0,0 +1,59 @@
+#!/usr/bin/env ruby
+
+# Runs the given benchmark programs with the collector statistics
+# enabled and reports wall time and the time spent in collections.
+#
+# Usage: ./gc_bench.rb [-n RUNS] [-r LABEL=RUNTIME_DIR ...] [-e LABEL=VAR=VALUE[,VAR=VALUE...] ...] PROGRAM...
+#
+# Every -r option adds a configuration which runs the programs against
+# the llscmrt library in RUNTIME_DIR (e.g. a build of an older revision).
+# That way we can compare the GC time of two runtime versions directly.
+# Every -e option adds a configuration which runs them with the given
+# environment variables (e.g. the LLSCHEME_* settings of eval).
+
+require "open3"
+require "optparse"
+require_relative "../colors"
+
+runs = 5
+configs = []
+
+OptionParser.new do |opts|
+	opts.on("-n RUNS", Integer) { |n| runs = n }
+	opts.on("-r LABEL=DIR") { |r| configs << r.split("=", 2) + [{}] }
+	opts.on("-e LABEL=VARS") do |e|
+		label, vars = e.split("=", 2)
+		configs << [label, nil, Hash[vars.split(",").map { |v| v.split("=", 2) }]]
+	end
+end.parse!
+
+configs << ["current", nil, {}] if configs.empty?
+
+def run_once(prog, runtime_dir, vars)
+	env = { "GC_PRINT_STATS" => "1" }.merge(vars)
+	env["LD_LIBRARY_PATH"] = runtime_dir if runtime_dir
+
+	start = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+	_, err, status = Open3.capture3(env, File.join(".", prog))
+	wall = Process.clock_gettime(Process::CLOCK_MONOTONIC) - start
+	abort "#{prog} failed:\n#{err}" unless status.success?
+
+	# Older collectors print "took N msecs", newer ones "took N ms M ns"
+	gc_ms = 0.0
+	collections = 0
+	err.scan(/[Cc]omplete collection took (\d+) ms(?:ecs)?(?: (\d+) ns)?/) do |ms, ns|
+		gc_ms += ms.to_i + ns.to_i / 1.0e6
+		collections += 1
+	end
+
+	[wall * 1000, gc_ms, collections]
+end
+
+ARGV.each do |prog|
+	puts prog.bold.light_yellow
+	configs.each do |label, dir, vars|
+		results = Array.new(runs) { run_once(prog, dir, vars) }
+		wall, gc, count = results.transpose.map { |r| r.sort[r.size / 2] }
+		printf("  %-12s wall %9.1f ms   gc %9.1f ms   collections %d\n", label, wall, gc, count)
+	end
+end
@@ -0,0 +1,20 @@
+; Captured variables of deeply nested closures. The inner loop reads
+; variables from four levels up on every iteration. Compare the chained
+; and flat closure representations with "make closure-bench".
+
+(define (newline)
+  (display "\n"))
+
+(define (level1 a)
+  (lambda (b)
+	 (lambda (c)
+		(lambda (d)
+		  (lambda (n)
+			 (define (loop i acc)
+				(if (= i n)
+				  acc
+				  (loop (+ i 1) (+ acc (+ (+ a b) (+ c d))))))
+			 (loop 0 0))))))
+
+(display (((((level1 1) 2) 3) 4) 50000000))
+(newline)
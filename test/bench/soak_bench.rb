@@ -0,0 +1,54 @@
+#!/usr/bin/env ruby
+
+# Runs a long program and samples its resident memory. Fails if the memory
+# keeps growing: the peak of the second half of the run must stay within
+# LIMIT percent of the peak of the first half.
+#
+# Usage: ./soak_bench.rb [-l LIMIT] [-e VAR=VALUE ...] PROGRAM
+
+require "optparse"
+require_relative "../colors"
+
+limit = 20
+env = {}
+
+OptionParser.new do |opts|
+	opts.on("-l LIMIT", Integer) { |l| limit = l }
+	opts.on("-e VAR=VALUE") { |e| env.store(*e.split("=", 2)) }
+end.parse!
+
+prog = ARGV[0] or abort "Usage: #{$0} [-l LIMIT] [-e VAR=VALUE ...] PROGRAM"
+
+def rss_kb(pid)
+	status = File.read("/proc/#{pid}/status") rescue nil
+	status && status[/^VmRSS:\s+(\d+)/, 1].to_i
+end
+
+start = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+pid = Process.spawn(env, File.join(".", prog))
+samples = []
+status = nil
+
+loop do
+	_, status = Process.waitpid2(pid, Process::WNOHANG)
+	break if status
+	rss = rss_kb(pid)
+	samples << [Process.clock_gettime(Process::CLOCK_MONOTONIC) - start, rss] if rss
+	sleep 0.2
+end
+
+abort "#{prog} failed" unless status.success?
+abort "#{prog} finished too early" if samples.size < 4
+
+half = samples.last[0] / 2
+first, second = samples.partition { |t, _| t < half }.map { |s| s.map(&:last).max }
+growth = (second - first) * 100.0 / first
+
+puts prog.bold.light_yellow
+printf("  wall %9.1f s   peak rss %d kB (first half), %d kB (second half), %+.1f %%\n",
+	samples.last[0], first, second, growth)
+
+if growth > limit
+	puts "  memory use keeps growing".red
+	exit 1
+end
@@ -0,0 +1,51 @@
+#!/usr/bin/env ruby
+
+# Measures the startup cost of compiled programs: wall time of a short
+# program (e.g. hellow) and the work of the dynamic linker.
+#
+# Usage: ./startup_bench.rb [-n RUNS] [-r LABEL=RUNTIME_DIR ...] PROGRAM...
+#
+# As in gc_bench.rb, every -r option runs the programs against
+# the runtime libraries in RUNTIME_DIR (e.g. a build of an older revision).
+
+require "open3"
+require "optparse"
+require_relative "../colors"
+
+runs = 50
+configs = []
+
+OptionParser.new do |opts|
+	opts.on("-n RUNS", Integer) { |n| runs = n }
+	opts.on("-r LABEL=DIR") { |r| configs << r.split("=", 2) }
+end.parse!
+
+configs << ["current", nil] if configs.empty?
+
+def run_once(prog, runtime_dir, stats)
+	env = {}
+	env["LD_LIBRARY_PATH"] = runtime_dir if runtime_dir
+	env["LD_DEBUG"] = "statistics" if stats
+
+	start = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+	_, err, status = Open3.capture3(env, File.join(".", prog))
+	wall = Process.clock_gettime(Process::CLOCK_MONOTONIC) - start
+	abort "#{prog} failed:\n#{err}" unless status.success?
+
+	[wall * 1000, err]
+end
+
+# Symbol and relative relocations processed by ld.so at startup
+def relocations(err)
+	err[/number of relocations:\s*(\d+)/, 1].to_i + err[/number of relative relocations:\s*(\d+)/, 1].to_i
+end
+
+ARGV.each do |prog|
+	puts prog.bold.light_yellow
+	configs.each do |label, dir|
+		walls = Array.new(runs) { run_once(prog, dir, false)[0] }.sort
+		relocs = relocations(run_once(prog, dir, true)[1])
+		printf("  %-12s wall %8.2f ms (min %8.2f)   relocations %d\n",
+		       label, walls[walls.size / 2], walls[0], relocs)
+	end
+end
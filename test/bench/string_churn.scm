@@ -0,0 +1,30 @@
+; GC benchmark: lots of short-lived strings while a window
+; of recent results stays reachable
+
+(define (newline)
+  (display "\n"))
+
+(define (build-str n acc)
+  (if (= n 0)
+	 acc
+	 (build-str (- n 1) (string-append acc "abcdefgh"))))
+
+(define (take lst n)
+  (if (or (= n 0) (null? lst))
+	 null
+	 (cons (car lst) (take (cdr lst) (- n 1)))))
+
+(define (churn n live)
+  (if (= n 0)
+	 live
+	 (churn (- n 1) (cons (build-str 32 "") (take live 256)))))
+
+(define (run rounds)
+  (if (= rounds 0)
+	 #t
+	 (let ((live (churn 1000 null)))
+		(run (- rounds 1)))))
+
+(run 200)
+(display "done")
+(newline)
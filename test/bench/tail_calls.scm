@@ -0,0 +1,30 @@
+; Stress test of proper tail calls: 10^8 calls in tail position,
+; both direct mutual recursion and indirect calls of function values.
+; Without guaranteed tail calls this overflows the native stack.
+
+(define (newline)
+  (display "\n"))
+
+(define (ping n)
+  (if (= n 0)
+	 'ping
+	 (pong (- n 1))))
+
+(define (pong n)
+  (if (= n 0)
+	 'pong
+	 (ping (- n 1))))
+
+; The next state is passed around as a value (indirect calls)
+(define (state-a next other n)
+  (if (= n 0)
+	 'a
+	 (next other next (- n 1))))
+
+(define (state-b next other n)
+  (if (= n 0)
+	 'b
+	 (next other next (- n 1))))
+
+(display (ping 100000000)) (newline)
+(display (state-a state-b state-a 100000000)) (newline)
@@ -0,0 +1,30 @@
+(define (newline)
+  (display "\n"))
+
+(define (my-map f lst)
+  (if (null? lst)
+	 null
+	 (cons (f (car lst)) (my-map f (cdr lst)))))
+
+; The closure is only called by my-map,
+; its data can live on the stack of scale.
+(define (scale k lst)
+  (let ((res (my-map (lambda (x) (* k x)) lst)))
+	 res))
+
+; Same for the library functions which don't keep
+; their arguments (according to the library metadata)
+(define (offset k lst)
+  (let ((res (map (lambda (x) (+ k x)) lst)))
+	 res))
+
+; Returned closure must stay on the heap
+(define (make-adder k)
+  (lambda (x) (+ x k)))
+
+(display (scale 3 (list 1 2 3)))
+(newline)
+(display (my-map (make-adder 10) (list 1 2 3)))
+(newline)
+(display (offset 100 (list 1 2 3)))
+(newline)
@@ -0,0 +1,9 @@
+(define ns (make-base-namespace))
+
+; The expressions can use the definitions of the previous ones
+(displayln (eval-batch '((define (f x) (* x 2)) (define (g x) (f (+ x 1))) (g 3)) ns))
+(eval-batch '((displayln "first") (displayln (g 10)) (displayln "third")) ns)
+
+; The expressions before the failing one are evaluated, the program exits
+(eval-batch '((displayln "before the error") (car 1) (displayln "not reached")) ns)
+(displayln "not reached")
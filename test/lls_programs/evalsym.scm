@@ -0,0 +1,11 @@
+(define (newline)
+  (display "\n"))
+
+; The symbols of the eval'd code survive a collection.
+; only-in-eval is not in this program, just in the code compiled by eval.
+(define ns (make-base-namespace))
+(eval '(define (eval-sym) 'foo) ns)
+(eval (list 'define (list 'eval-only-sym) (list 'quote (string->symbol "only-in-eval"))) ns)
+(collect-garbage)
+(display (eq? (eval '(eval-sym) ns) 'foo)) (newline)
+(display (eq? (eval '(eval-only-sym) ns) (string->symbol "only-in-eval"))) (newline)
@@ -0,0 +1,3 @@
+; Quoted data compiled in a separate module
+(define lib-sym 'foo)
+(define lib-list '(foo bar))
@@ -0,0 +1,24 @@
+(define (newline)
+  (display "\n"))
+
+; Fixnum fast paths
+(display (+ 40 2)) (newline)
+(display (- 40 42)) (newline)
+(display (* -6 7)) (newline)
+(display (> 3 -3)) (newline)
+(display (= 7 7)) (newline)
+(display (< -3 3)) (newline)
+(display (<= 3 3)) (newline)
+(display (>= 2 3)) (newline)
+
+; Overflow and mixed arguments fall back to the runtime
+(display (+ 4611686018427387903 1)) (newline)
+(display (* 4611686018427387903 2)) (newline)
+(display (- 10 2.5)) (newline)
+(display (> 2.5 2)) (newline)
+(display (< 2 2.5)) (newline)
+(display (>= 2.0 2)) (newline)
+
+(define lst (cons 1 (cons 2 '())))
+(display (car (cdr lst))) (newline)
+(display (null? (cdr (cdr lst)))) (newline)
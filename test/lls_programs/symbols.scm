@@ -0,0 +1,23 @@
+(require "lib/quoted")
+
+(define (newline)
+  (display "\n"))
+
+; Symbols are interned, eq? compares them by identity
+(display (eq? 'foo 'foo)) (newline)
+(display (eq? 'foo (string->symbol "foo"))) (newline)
+(display (eq? 'foo 'bar)) (newline)
+(display (equal? '(a b c) (list 'a 'b (string->symbol "c")))) (newline)
+(display (eq? 42 42)) (newline)
+(display (eq? "str" "str")) (newline)
+(display (eq? 'foo lib-sym)) (newline)
+(display (eq? 'bar (cadr lib-list))) (newline)
+(display (eq? (string->symbol "bar") (cadr lib-list))) (newline)
+
+; There is one object of each of '(), #t and #f
+(display (eq? '() '())) (newline)
+(display (eq? (cdr (list 1)) '())) (newline)
+(display (eq? '() (cddr lib-list))) (newline)
+(display (eq? #t (= 1 1))) (newline)
+(display (eq? #f (null? lib-list))) (newline)
+(display (apply eq? (list '() (cdr (list 1))))) (newline)
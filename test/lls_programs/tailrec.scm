@@ -0,0 +1,20 @@
+(define (newline)
+  (display "\n"))
+
+; Self tail calls run in constant stack space
+(define (count-up i n acc)
+  (if (= i n)
+	 acc
+	 (count-up (+ i 1) n (+ acc i))))
+
+(define (even-length? lst)
+  (cond-loop lst #t))
+
+(define (cond-loop lst acc)
+  (if (null? lst)
+	 acc
+	 (let ((rest (cdr lst)))
+		(cond-loop rest (not acc)))))
+
+(display (count-up 0 10000000 0)) (newline)
+(display (even-length? '(1 2 3 4))) (newline)